@@ -0,0 +1,98 @@
+/*************************************************************************/
+/* bench-dispatch.cpp - OSC path dispatch benchmark                      */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-dispatch.cpp
+	compares a strcmp chain with osc_dispatcher for 10, 100 and 1000 paths
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <spa/audio.h>
+
+using spa::audio::osc_msg;
+using spa::audio::osc_dispatcher;
+
+struct counter { unsigned long hits = 0; };
+
+static void count(counter& c, const osc_msg& , const char* ) { ++c.hits; }
+
+//! @return nanoseconds per message
+template<class Dispatch>
+static double bench(const osc_msg* msgs, int nmsgs, Dispatch dispatch)
+{
+	const int rounds = (1 << 21) / nmsgs;
+	counter c;
+	auto start = std::chrono::steady_clock::now();
+	for(int r = 0; r < rounds; ++r)
+		for(int i = 0; i < nmsgs; ++i)
+			dispatch(c, msgs[i]);
+	auto end = std::chrono::steady_clock::now();
+	if(c.hits != (unsigned long)rounds * nmsgs)
+		std::puts("error: messages were not dispatched");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ ((double)rounds * nmsgs);
+}
+
+int main()
+{
+	const int max_paths = 1000, nmsgs = 256;
+	static char paths[max_paths][32], patterns[max_paths][32];
+	static char msg_bufs[nmsgs][64];
+	static osc_dispatcher<counter>::entry entries[max_paths];
+	osc_msg msgs[nmsgs];
+
+	std::printf("%-6s %14s %16s\n",
+		"paths", "strcmp ns/msg", "dispatch ns/msg");
+	for(int npaths : { 10, 100, 1000 })
+	{
+		for(int i = 0; i < npaths; ++i)
+		{
+			std::sprintf(paths[i], "/module%d/param%d", i / 10, i % 10);
+			std::sprintf(patterns[i], "%s:f", paths[i]);
+			entries[i] = { patterns[i], count };
+		}
+		// messages spread evenly over all paths
+		for(int i = 0; i < nmsgs; ++i)
+		{
+			pseudo_rtosc::rtosc_message(msg_bufs[i], sizeof(msg_bufs[i]),
+				paths[(i * 7919) % npaths], "f", 0.5f);
+			msgs[i] = osc_msg(msg_bufs[i]);
+		}
+
+		osc_dispatcher<counter> dispatcher;
+		dispatcher.init(entries, npaths);
+
+		std::printf("%-6d %14.2f %16.2f\n", npaths,
+			bench(msgs, nmsgs, [&](counter& c, const osc_msg& m) {
+				for(int p = 0; p < npaths; ++p)
+					if(!std::strcmp(m.path(), paths[p]) &&
+						!std::strcmp(m.types(), "f"))
+					{
+						count(c, m, nullptr);
+						break;
+					}
+			}),
+			bench(msgs, nmsgs, [&](counter& c, const osc_msg& m) {
+				dispatcher.dispatch(c, m); }));
+	}
+	return 0;
+}
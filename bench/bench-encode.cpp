@@ -0,0 +1,214 @@
+/*************************************************************************/
+/* bench-encode.cpp - OSC message encoder benchmark                      */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-encode.cpp
+	compares rtosc_amessage with the former two pass encoder
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <rtosc/pseudo-rtosc.h>
+
+using namespace pseudo_rtosc;
+
+namespace legacy {
+
+/*
+	the encoder as it was before the single pass version:
+	size the message, zero the buffer, then walk the type string again
+*/
+
+static int has_reserved(char type)
+{
+	return !!strchr("isbfhtdSrmc", type);
+}
+
+static unsigned nreserved(const char *args)
+{
+	unsigned res = 0;
+	for(;*args;++args)
+		res += has_reserved(*args);
+	return res;
+}
+
+static size_t vsosc_null(const char *address, const char *arguments,
+	const rtosc_arg_t *args)
+{
+	unsigned pos = 0;
+	pos += strlen(address);
+	pos += 4-pos%4;
+	pos += 1+strlen(arguments);
+	pos += 4-pos%4;
+
+	unsigned toparse = nreserved(arguments);
+	unsigned arg_pos = 0;
+	while(toparse)
+	{
+		switch(*arguments++) {
+			case 'h': case 't': case 'd':
+				++arg_pos; pos += 8; --toparse; break;
+			case 'm': case 'r': case 'c': case 'f': case 'i':
+				++arg_pos; pos += 4; --toparse; break;
+			case 's': case 'S':
+				pos += strlen(args[arg_pos++].s);
+				pos += 4-pos%4; --toparse; break;
+			case 'b':
+				pos += 4 + args[arg_pos++].b.len;
+				if(pos%4)
+					pos += 4-pos%4;
+				--toparse; break;
+			default: ;
+		}
+	}
+	return pos;
+}
+
+static size_t amessage(char *buffer, size_t len, const char *address,
+	const char *arguments, const rtosc_arg_t *args)
+{
+	const size_t total_len = vsosc_null(address, arguments, args);
+	if(total_len>len) {
+		memset(buffer, 0, len);
+		return 0;
+	}
+	memset(buffer, 0, total_len);
+
+	unsigned pos = 0;
+	while(*address)
+		buffer[pos++] = *address++;
+	pos += 4-pos%4;
+	buffer[pos++] = ',';
+	const char *arg_str = arguments;
+	while(*arg_str)
+		buffer[pos++] = *arg_str++;
+	pos += 4-pos%4;
+
+	unsigned toparse = nreserved(arguments);
+	unsigned arg_pos = 0;
+	while(toparse)
+	{
+		int32_t i;
+		int64_t d;
+		const char *s;
+		const unsigned char *u;
+		switch(*arguments++) {
+			case 'h': case 't': case 'd':
+				d = args[arg_pos++].t;
+				for(int sh = 56; sh >= 0; sh -= 8)
+					buffer[pos++] = ((d>>sh) & 0xff);
+				--toparse; break;
+			case 'r': case 'f': case 'c': case 'i':
+				i = args[arg_pos++].i;
+				for(int sh = 24; sh >= 0; sh -= 8)
+					buffer[pos++] = ((i>>sh) & 0xff);
+				--toparse; break;
+			case 'S': case 's':
+				s = args[arg_pos++].s;
+				while(*s)
+					buffer[pos++] = *s++;
+				pos += 4-pos%4;
+				--toparse; break;
+			case 'b':
+				i = args[arg_pos].b.len;
+				u = args[arg_pos++].b.data;
+				for(int sh = 24; sh >= 0; sh -= 8)
+					buffer[pos++] = ((i>>sh) & 0xff);
+				while(i--)
+					buffer[pos++] = *u++;
+				if(pos%4)
+					pos += 4-pos%4;
+				--toparse; break;
+			default: ;
+		}
+	}
+	return pos;
+}
+
+} // namespace legacy
+
+using encoder_t = size_t (*)(char*, size_t, const char*, const char*,
+	const rtosc_arg_t*);
+
+//! @return nanoseconds per message
+static double bench(encoder_t enc, const char* path, const char* types,
+	const rtosc_arg_t* args, int iterations)
+{
+	char buffer[256];
+	size_t sum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; ++i)
+	{
+		sum += enc(buffer, sizeof(buffer), path, types, args);
+		// keep the compiler from hoisting the encoder out of the loop
+		asm volatile("" : : "r"(buffer) : "memory");
+	}
+	auto end = std::chrono::steady_clock::now();
+	if(!sum)
+		std::puts("error: message did not fit");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ iterations;
+}
+
+int main()
+{
+	const int iterations = 2000000;
+	const unsigned char blob_data[12] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+	rtosc_arg_t f[1], iii[3], sb[2];
+	f[0].f = 0.5f;
+	iii[0].i = 0; iii[1].i = 69; iii[2].i = 100;
+	sb[0].s = "some-string-argument";
+	sb[1].b.len = sizeof(blob_data);
+	sb[1].b.data = (uint8_t*)blob_data;
+
+	struct shape_t {
+		const char *path, *types;
+		const rtosc_arg_t* args;
+	} shapes[] = {
+		{ "/part0/Pvolume", "f", f },
+		{ "/noteOn", "iii", iii },
+		{ "/load-object", "sb", sb }
+	};
+
+	std::printf("%-6s %12s %12s\n", "shape", "old ns/msg", "new ns/msg");
+	for(const shape_t& s : shapes)
+	{
+		char old_msg[256], new_msg[256];
+		size_t old_len = legacy::amessage(old_msg, sizeof(old_msg),
+			s.path, s.types, s.args);
+		size_t new_len = rtosc_amessage(new_msg, sizeof(new_msg),
+			s.path, s.types, s.args);
+		if(old_len != new_len || memcmp(old_msg, new_msg, old_len))
+		{
+			std::printf("error: encoders differ for \"%s\"\n",
+				s.types);
+			return 1;
+		}
+
+		std::printf("%-6s %12.2f %12.2f\n", s.types,
+			bench(legacy::amessage, s.path, s.types, s.args,
+				iterations),
+			bench(rtosc_amessage, s.path, s.types, s.args,
+				iterations));
+	}
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*************************************************************************/
+/* bench-mpsc.cpp - multi producer OSC ringbuffer benchmark              */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-mpsc.cpp
+	compares a mutex protected osc_ringbuffer with the lock-free
+	osc_mpsc_ringbuffer for 1, 2 and 4 writing threads
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <spa/audio.h>
+
+using spa::audio::osc_ringbuffer;
+using spa::audio::osc_mpsc_ringbuffer;
+using spa::audio::osc_ringbuffer_in;
+
+//! space that a writer waits for, enough for one message of each writer
+static const std::size_t max_msg_space = 32 * 4;
+
+struct locked_ringbuffer : public osc_ringbuffer
+{
+	std::mutex mutex;
+	bool write_typed(const char* dest, float f)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return osc_ringbuffer::write_typed(dest, f);
+	}
+	locked_ringbuffer(std::size_t size) : osc_ringbuffer(size) {}
+};
+
+//! let @p writers threads write @p per_writer messages each, while the
+//! main thread reads them
+//! @return nanoseconds per message
+template<class Ringbuffer>
+static double bench(int writers)
+{
+	const int total = 1 << 20, per_writer = total / writers;
+	Ringbuffer rb(1 << 16);
+	osc_ringbuffer_in in(1 << 16, 1024, 256);
+	in.connect(rb);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for(int w = 0; w < writers; ++w)
+		threads.emplace_back([&rb, per_writer]() {
+			// another writer can take the space between the check
+			// and the write, so retry failed writes
+			for(int i = 0; i < per_writer; )
+			{
+				if(rb.write_space() >= max_msg_space &&
+					rb.write_typed("/part0/Pvolume", 0.5f))
+					++i;
+				else
+					std::this_thread::yield();
+			}
+		});
+
+	std::size_t read = 0;
+	while(read < (std::size_t)per_writer * writers)
+	{
+		const std::size_t n = in.read_all().size();
+		if(!n)
+			std::this_thread::yield();
+		read += n;
+	}
+	for(std::thread& t : threads)
+		t.join();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ read;
+}
+
+int main()
+{
+	std::printf("%-8s %14s %14s\n", "writers", "mutex ns/msg", "mpsc ns/msg");
+	for(int writers : { 1, 2, 4 })
+	{
+		std::printf("%-8d %14.2f %14.2f\n", writers,
+			bench<locked_ringbuffer>(writers),
+			bench<osc_mpsc_ringbuffer>(writers));
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+/*************************************************************************/
+/* bench-port-index.cpp - port name lookup benchmark                     */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-port-index.cpp
+	compares resolving all port names of a plugin with a strcmp chain,
+	as plugins implement port() by hand, and with a port_index_table
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <spa/spa.h>
+
+static const unsigned nnames = 512;
+static char name_buf[nnames][24];
+static const char* names[nnames];
+
+//! what a hand written plugin::port() does
+static int strcmp_index(const char* name)
+{
+	for(unsigned i = 0; i < nnames; ++i)
+		if(!std::strcmp(names[i], name))
+			return i;
+	return -1;
+}
+
+//! @return nanoseconds per lookup
+template<class F>
+static double bench(F lookup)
+{
+	const int rounds = 100;
+	unsigned long sum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int r = 0; r < rounds; ++r)
+		for(const char* name : names)
+			sum += lookup(name);
+	auto end = std::chrono::steady_clock::now();
+	if(sum != rounds * (nnames * (nnames - 1ul) / 2))
+		std::puts("error: wrong indices");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ ((double)rounds * nnames);
+}
+
+int main()
+{
+	for(unsigned i = 0; i < nnames; ++i)
+	{
+		std::snprintf(name_buf[i], sizeof(name_buf[i]),
+			"voice%u/filter/cutoff", i);
+		names[i] = name_buf[i];
+	}
+	const spa::port_index_table table(names, nnames);
+
+	std::printf("%u port names\n", nnames);
+	std::printf("%-14s %8.2f ns/lookup\n", "strcmp chain",
+		bench(strcmp_index));
+	std::printf("%-14s %8.2f ns/lookup\n", "index table",
+		bench([&](const char* n) { return table.index(n); }));
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*************************************************************************/
+/* bench-port-table.cpp - control port layout benchmark                  */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-port-table.cpp
+	compares a block of control updates where the plugin reads 10000
+	control_in<float> objects with one where it reads a port_table
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include <spa/audio.h>
+
+namespace audio = spa::audio;
+
+static const unsigned n = 10000;
+
+//! @return nanoseconds per control and block
+template<class Block>
+static double bench(Block block)
+{
+	const int rounds = 1000;
+	double sum = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for(int r = 0; r < rounds; ++r)
+		sum += block(r);
+	auto end = std::chrono::steady_clock::now();
+	if(sum != (double)n * rounds * (rounds - 1) / 2)
+		std::puts("error: wrong control values");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ ((double)rounds * n);
+}
+
+int main()
+{
+	static float host_values[n];
+	static const char* names[n];
+	for(const char*& name : names)
+		name = "control";
+
+	// legacy: each port is its own object, allocated one by one like the
+	// members of different plugin classes
+	static audio::control_in<float>* ports[n];
+	for(unsigned i = 0; i < n; ++i)
+	{
+		ports[i] = new audio::control_in<float>;
+		ports[i]->set_ref(host_values + i);
+	}
+
+	audio::port_table table(names, n, nullptr, 0);
+
+	std::printf("%u controls\n", n);
+	std::printf("%-14s %8.3f ns/control\n", "port objects",
+		bench([&](int r) {
+			for(float& v : host_values)
+				v = r;
+			float sum = 0.0f;
+			for(audio::control_in<float>* p : ports)
+				sum += *p;
+			return sum; }));
+	std::printf("%-14s %8.3f ns/control\n", "port table",
+		bench([&](int r) {
+			for(float& v : host_values)
+				v = r;
+			table.write_controls(host_values);
+			table.publish_controls();
+			table.fetch_controls();
+			float sum = 0.0f;
+			for(unsigned i = 0; i < n; ++i)
+				sum += table.control(i);
+			return sum; }));
+
+	for(audio::control_in<float>* p : ports)
+		delete p;
+	return 0;
+}
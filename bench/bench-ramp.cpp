@@ -0,0 +1,112 @@
+/*************************************************************************/
+/* bench-ramp.cpp - control smoothing benchmark                          */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-ramp.cpp
+	compares ramping 4096 controls, half of them logarithmic and one in
+	eight changing per block, with a ramp_bank and with hand written
+	interpolation, which computes the step or factor once per block and
+	advances the value sample by sample
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include <spa/audio.h>
+
+namespace audio = spa::audio;
+
+static const unsigned n = 4096, frames = 128, rounds = 200;
+
+//! the target of control @p i in round @p r, changing every 8 rounds
+static float target(unsigned i, unsigned r) {
+	return 1.0f + (r + i % 8) / 8 % 4; }
+
+//! @return nanoseconds per control and block
+template<class Block>
+static double bench(Block block)
+{
+	static float out[frames];
+	double sum = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned r = 0; r < rounds; ++r)
+		sum += block(r, out);
+	auto end = std::chrono::steady_clock::now();
+	std::printf("(checksum %.0f) ", sum);
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ ((double)rounds * n);
+}
+
+int main()
+{
+	audio::ramp_bank bank(n);
+	for(unsigned i = 0; i < n; i += 2)
+		bank.set_scale(i, audio::scale_type_t::logartihmic);
+	static float prev[n];
+
+	std::printf("%u controls, %u frames\n", n, frames);
+	const double hand = bench([&](unsigned r, float* out) {
+		double sum = 0.0;
+		for(unsigned i = 0; i < n; ++i)
+		{
+			const float c = prev[i] ? prev[i] : target(i, 0),
+				t = target(i, r);
+			// the per-sample step or factor, once per block
+			float v = c;
+			if(t == c)
+			{
+				for(unsigned k = 0; k < frames; ++k)
+					out[k] = c;
+			}
+			else if(i % 2)
+			{
+				const float step = (t - c) / frames;
+				for(unsigned k = 0; k < frames; ++k)
+					out[k] = (v += step);
+			}
+			else
+			{
+				const float factor = std::pow(t / c, 1.0f / frames);
+				for(unsigned k = 0; k < frames; ++k)
+					out[k] = (v *= factor);
+			}
+			prev[i] = t;
+			sum += out[frames - 1];
+		}
+		return sum; });
+	std::printf("%-14s %8.2f ns/control\n", "hand written", hand);
+
+	for(unsigned i = 0; i < n; ++i)
+		bank.reset(i, target(i, 0));
+	const double banked = bench([&](unsigned r, float* out) {
+		double sum = 0.0;
+		for(unsigned i = 0; i < n; ++i)
+			bank.set_target(i, target(i, r));
+		bank.begin_block(frames);
+		for(unsigned i = 0; i < n; ++i)
+		{
+			bank.ramp(i, out);
+			sum += out[frames - 1];
+		}
+		bank.end_block();
+		return sum; });
+	std::printf("%-14s %8.2f ns/control\n", "ramp_bank", banked);
+	return 0;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************/
+/* bench-ringbuffer.cpp - OSC ringbuffer write benchmark                 */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-ringbuffer.cpp
+	compares single writes with transactions on the osc_ringbuffer
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include <spa/audio.h>
+
+using spa::audio::osc_ringbuffer;
+using spa::audio::osc_ringbuffer_in;
+
+//! write @p batch messages per block, then let the plugin drain them
+//! @return nanoseconds per message
+template<class WriteBlock>
+static double bench(int batch, WriteBlock write_block)
+{
+	const int total = 1 << 21;
+	osc_ringbuffer rb(1 << 16);
+	osc_ringbuffer_in in(1 << 16, 1024, batch);
+	in.connect(rb);
+
+	std::size_t read = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int blocks = total / batch; blocks; --blocks)
+	{
+		write_block(rb, batch);
+		read += in.read_all().size();
+	}
+	auto end = std::chrono::steady_clock::now();
+	if(read != (std::size_t)(total / batch * batch))
+		std::puts("error: messages got lost");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ read;
+}
+
+static void write_single(osc_ringbuffer& rb, int batch)
+{
+	for(int i = 0; i < batch; ++i)
+		rb.write("/part0/Pvolume", "f", 0.5f);
+}
+
+static void write_transaction(osc_ringbuffer& rb, int batch)
+{
+	osc_ringbuffer::transaction t(rb);
+	for(int i = 0; i < batch; ++i)
+		t.write("/part0/Pvolume", "f", 0.5f);
+	if(!t.commit())
+		std::puts("error: transaction failed");
+}
+
+int main()
+{
+	std::printf("%-6s %14s %15s\n",
+		"batch", "single ns/msg", "transact ns/msg");
+	for(int batch : { 1, 8, 64, 512 })
+	{
+		std::printf("%-6d %14.2f %15.2f\n", batch,
+			bench(batch, write_single),
+			bench(batch, write_transaction));
+	}
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*************************************************************************/
+/* bench-validate.cpp - OSC validator benchmark                          */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-validate.cpp
+	compares rtosc_valid_packets with the former isprint based validator
+*/
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+
+#include <rtosc/pseudo-rtosc.h>
+
+using namespace pseudo_rtosc;
+
+namespace legacy {
+
+//! the validator as it was before the single pass version
+static bool valid_message_p(const char *msg, size_t len)
+{
+	if(*msg != '/')
+		return false;
+	const char *tmp = msg;
+	for(unsigned i = 0; i < len; ++i) {
+		if(*tmp == 0)
+			break;
+		if(!isprint(*tmp))
+			return false;
+		tmp++;
+	}
+
+	const size_t offset1 = tmp - msg;
+	size_t       offset2 = tmp - msg;
+	for(; offset2 < len; offset2++) {
+		if(*tmp == ',')
+			break;
+		tmp++;
+	}
+
+	if(offset2 - offset1 > 4)
+		return false;
+	if((offset2 % 4) != 0)
+		return false;
+
+	return rtosc_message_length(msg, len) == len;
+}
+
+}
+
+//! @return processed bytes per nanosecond, i.e. GB/s
+template<class Validate>
+static double bench(size_t total, Validate validate)
+{
+	const int rounds = 2000;
+	size_t good = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int r = 0; r < rounds; ++r)
+		good += validate();
+	auto end = std::chrono::steady_clock::now();
+	if(!good)
+		std::puts("error: no message was valid");
+	return (double)total * rounds
+		/ std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main()
+{
+	const int nmsgs = 1024;
+	static char bufs[nmsgs][256];
+	static const char* packets[nmsgs];
+	static size_t lens[nmsgs];
+	static bool valid[nmsgs];
+	size_t total = 0;
+
+	for(int i = 0; i < nmsgs; ++i)
+	{
+		char path[64];
+		std::snprintf(path, sizeof(path),
+			"/synth/voice%d/filter/cutoff/amount", i);
+		switch(i % 3)
+		{
+			case 0: lens[i] = rtosc_message(bufs[i], sizeof(bufs[i]),
+				path, "f", 0.5f); break;
+			case 1: lens[i] = rtosc_message(bufs[i], sizeof(bufs[i]),
+				path, "iis", 1, 2, "a string argument"); break;
+			default: lens[i] = rtosc_message(bufs[i], sizeof(bufs[i]),
+				path, "ffff", 0.f, 1.f, 2.f, 3.f); break;
+		}
+		packets[i] = bufs[i];
+		total += lens[i];
+	}
+
+	double old_rate = bench(total, [&]() {
+		size_t good = 0;
+		for(int i = 0; i < nmsgs; ++i)
+			good += legacy::valid_message_p(packets[i], lens[i]);
+		return good;
+	});
+	double single_rate = bench(total, [&]() {
+		size_t good = 0;
+		for(int i = 0; i < nmsgs; ++i)
+			good += rtosc_valid_message_p(packets[i], lens[i]);
+		return good;
+	});
+	double batch_rate = bench(total, [&]() {
+		return rtosc_valid_packets(packets, lens, nmsgs, valid);
+	});
+
+	std::printf("%-24s %8.2f GB/s\n", "isprint loop", old_rate);
+	std::printf("%-24s %8.2f GB/s\n", "rtosc_valid_message_p", single_rate);
+	std::printf("%-24s %8.2f GB/s\n", "rtosc_valid_packets", batch_rate);
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+/*************************************************************************/
+/* bench-visit.cpp - port visiting benchmark                             */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file bench-visit.cpp
+	compares connecting 10000 ports through accept() with the former
+	dynamic_cast based accept()
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include <spa/audio.h>
+
+namespace audio = spa::audio;
+
+//! a port as it is, only constructible without arguments
+template<class Port> struct current_port : public Port {};
+template<> struct current_port<audio::osc_ringbuffer_in> :
+	public audio::osc_ringbuffer_in {
+	current_port() : audio::osc_ringbuffer_in(1024) {} };
+
+//! a port whose accept() works as before, i.e. with dynamic_cast
+template<class Port>
+struct legacy_port : public current_port<Port>
+{
+	void accept(spa::visitor& v) override {
+		dynamic_cast<audio::visitor&>(v).visit(static_cast<Port&>(*this)); }
+};
+
+//! the visitor of a host which connects all ports to one value
+struct host_visitor : public virtual audio::visitor
+{
+	float value = 0.0f;
+	int in_count = 0;
+	unsigned long visited = 0;
+
+	using audio::visitor::visit;
+	void visit(audio::control_in<float>& p) override {
+		p.set_ref(&value), ++visited; }
+	void visit(audio::in& p) override {
+		p.set_ref(&value), ++visited; }
+	void visit(spa::port_ref<const int>& p) override {
+		p.set_ref(&in_count), ++visited; }
+	void visit(spa::port_ref_base& ) override { ++visited; }
+};
+
+//! a plugin's ports: controls, audio inputs, buffersizes and OSC inputs
+template<template<class> class Wrap>
+struct port_set
+{
+	static const int n = 2500;
+	Wrap<audio::control_in<float>> controls[n];
+	Wrap<audio::in> ins[n];
+	Wrap<audio::buffersize> buffersizes[n];
+	Wrap<audio::osc_ringbuffer_in> oscs[n];
+	spa::port_ref_base* ports[4 * n];
+	port_set()
+	{
+		for(int i = 0; i < n; ++i)
+		{
+			ports[4 * i] = controls + i;
+			ports[4 * i + 1] = ins + i;
+			ports[4 * i + 2] = buffersizes + i;
+			ports[4 * i + 3] = oscs + i;
+		}
+	}
+};
+
+//! @return nanoseconds per port
+template<class Set>
+static double bench(Set& set)
+{
+	const int rounds = 50, nports = sizeof(set.ports) / sizeof(*set.ports);
+	host_visitor v;
+	auto start = std::chrono::steady_clock::now();
+	for(int r = 0; r < rounds; ++r)
+		for(spa::port_ref_base* p : set.ports)
+			p->accept(v);
+	auto end = std::chrono::steady_clock::now();
+	if(v.visited != (unsigned long)rounds * nports)
+		std::puts("error: ports were not visited");
+	return std::chrono::duration<double, std::nano>(end - start).count()
+		/ ((double)rounds * nports);
+}
+
+int main()
+{
+	static port_set<legacy_port> legacy;
+	static port_set<current_port> current;
+	const int nports = sizeof(current.ports) / sizeof(*current.ports);
+	std::printf("%d ports\n", nports);
+	std::printf("%-14s %8.2f ns/port\n", "dynamic_cast", bench(legacy));
+	std::printf("%-14s %8.2f ns/port\n", "family table", bench(current));
+	return 0;
+}
@@ -68,6 +68,13 @@ private:
 	// for controls where we do not know the meaning (but the user will)
 	std::vector<float> unknown_controls;
 	std::unique_ptr<spa::audio::osc_ringbuffer> rb;
+	std::unique_ptr<spa::audio::osc_latest_table> latest;
+	//! return channel of the plugin, and our reader for it
+	std::unique_ptr<spa::audio::osc_ringbuffer> meter_rb;
+	std::unique_ptr<spa::audio::osc_ringbuffer_in> meter_in;
+	//! the plugin's flat port table, and our values for its controls
+	spa::audio::port_table* table = nullptr;
+	std::vector<float> table_controls;
 
 //	std::map<std::string, port_base*> ports;
 };
@@ -93,8 +100,25 @@ void osc_host::play(int time)
 	if(!plugin)
 		return;
 
-	// simulate automation from the host
-	rb->write("/gain", "f", (float)fmod(time/10.0f, 1.0f));
+	// simulate a fast automation ramp, of which only the latest value
+	// reaches the plugin, at the start of the block
+	if(time)
+	{
+		for(int step = 1; step <= 8; ++step)
+			latest->write_typed("/gain", (time - 2 + step / 8.0f) / 10);
+	}
+
+	// simulate automation from the host, changing the gain in the middle
+	// of the block
+	const int frame = buffersize / 2;
+	rb->write_typed_at(frame, "/gain", (float)fmod(time/10.0f, 1.0f));
+
+	// all controls of the table in one go, as one snapshot
+	if(table)
+	{
+		table->write_controls(table_controls.data());
+		table->publish_controls();
+	}
 
 	// provide audio input
 	for(int i = 0; i < buffersize; ++i)
@@ -108,10 +132,24 @@ void osc_host::play(int time)
 	// check output
 	for(int i = 0; i < buffersize; ++i)
 	{
+		const float expected = 0.01f * ((i < frame && time) ? time - 1
+			: time);
 		all_ok = all_ok &&
-			(fabs(processed_l[i] - 0.01f * time) < 0.0001f) &&
-			(fabs(processed_r[i] - 0.01f * time) < 0.0001f);
+			(fabs(processed_l[i] - expected) < 0.0001f) &&
+			(fabs(processed_r[i] - expected) < 0.0001f);
 	}
+
+	// check the peak that the plugin reported
+	std::size_t peaks = meter_in->drain([&](const spa::audio::osc_msg& m) {
+		all_ok = all_ok && !strcmp(m.path(), "/peak") &&
+			!strcmp(m.types(), "f") &&
+			(fabs(m.arg(0).f - 0.01f * time) < 0.0001f);
+	});
+	all_ok = all_ok && (peaks == 1);
+
+	// no message may have been lost on the way
+	all_ok = all_ok && !rb->dropped_messages() &&
+		!meter_rb->dropped_messages();
 }
 
 struct host_visitor : public virtual spa::audio::visitor
@@ -146,9 +184,34 @@ struct host_visitor : public virtual spa::audio::visitor
 		else {
 			h->rb.reset(
 				new spa::audio::osc_ringbuffer(p.get_size()));
+			h->latest.reset(new spa::audio::osc_latest_table(16));
 			p.connect(*h->rb);
+			p.connect(*h->latest);
 		}
 	}
+	virtual void visit(spa::audio::osc_ringbuffer_out& p) override {
+		std::cout << "ringbuffer output" << std::endl;
+		if(h->meter_rb)
+			throw std::runtime_error("can not handle 2 OSC out ports");
+		else {
+			h->meter_rb.reset(
+				new spa::audio::osc_ringbuffer(p.get_size()));
+			h->meter_in.reset(
+				new spa::audio::osc_ringbuffer_in(p.get_size()));
+			p.connect(*h->meter_rb);
+			h->meter_in->connect(*h->meter_rb);
+		}
+	}
+
+	virtual void visit(spa::audio::port_table& p) override {
+		std::cout << "port table" << std::endl;
+		h->table = &p;
+		// "trim" is a factor, keep it neutral
+		h->table_controls.assign(p.control_count(), 0.0f);
+		for(unsigned i = 0; i < p.control_count(); ++i)
+			if(!strcmp(p.control_name(i), "trim"))
+				h->table_controls[i] = 1.0f;
+	}
 
 	virtual void visit(spa::port_ref<const float>& p) override {
 		std::cout << "unknown control port" << std::endl;;
@@ -187,14 +250,28 @@ bool osc_host::init_plugin()
 	const spa::simple_vec<spa::simple_str> port_names =
 		descriptor->port_names();
 
-	for(const spa::simple_str& port_name : port_names)
+	for(unsigned index = 0; index < port_names.size(); ++index)
 	{
+		const spa::simple_str& port_name = port_names[index];
 		try
 		{
 			std::cout << "portname: " << port_name.data()
 				  << std::endl;
-			spa::port_ref_base& port_ref =
-				plugin->port(port_name.data());
+			// resolve the name once, then connect by index
+			if(descriptor->port_index(port_name.data()) != (int)index)
+			{
+				std::cerr << "port index of \"" << port_name.data()
+					<< "\" does not match port_names()" << std::endl;
+				return false;
+			}
+			spa::port_ref_base* port_ptr;
+			try {
+				port_ptr = &plugin->port_at(index);
+			} catch(spa::port_not_found_error& ) {
+				// plugin does not support indices
+				port_ptr = &plugin->port(port_name.data());
+			}
+			spa::port_ref_base& port_ref = *port_ptr;
 
 			// here comes the difficult part:
 			// * what port type is in the plugin?
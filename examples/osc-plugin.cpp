@@ -20,14 +20,24 @@
 /**
 	@file osc-plugin.cpp
 	a simple example gain plugin
-	less than 150 LOC, including license and metadata
+	less than 200 LOC, including license and metadata
 */
 
-#include <cstring>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 #include <spa/audio.h>
 
+//! names of the ports, their positions are the port indices
+static const char* const port_name_list[] =
+	{ "in", "out", "buffersize", "osc", "meter", "ports" };
+//! names of the controls in the flat port table
+static const char* const control_name_list[] = { "trim" };
+static const spa::port_index_table port_indices(port_name_list,
+	sizeof(port_name_list) / sizeof(*port_name_list));
+
 class example_plugin : public spa::plugin
 {
 	//! ports can be extended, this is being hidden from the source
@@ -40,36 +50,75 @@ class example_plugin : public spa::plugin
 public:
 	void run() override
 	{
-		while(osc_in.read_msg())
+		using spa::audio::sub_block;
+		using spa::audio::split_block;
+		table.fetch_controls();
+		// de-zipper the trim, it fades in during the first block
+		trim_ramp.set_targets(table.controls());
+		trim_ramp.begin_block(buffersize);
+		for(const spa::audio::osc_msg& msg : osc_in.read_latest())
+			dispatcher.dispatch(*this, msg);
+		for(const sub_block& b : split_block(osc_in.read_all(), buffersize))
 		{
-			if(!strcmp(osc_in.path(), "/gain"))
+			for(const spa::audio::osc_msg& msg : b.events)
+			{
+				if(!dispatcher.dispatch(*this, msg))
+				{
+					std::cerr << "warning: unsupported "
+						"OSC string \"" << msg.path()
+						<< "\", ignoring...";
+				}
+			}
+
+			// the block may be longer than trim_buf, which init() sized
+			// for the block size at that time, so ramp it in chunks
+			const unsigned chunk = trim_buf.size();
+			for(unsigned i0 = b.start; i0 < b.stop; i0 += chunk)
 			{
-				spa::audio::assert_types_are("/gain",
-					"f", osc_in.types());
-				gain = osc_in.arg(0).f;
-			} else {
-				std::cerr << "warning: unsupported "
-					"OSC string \"" << osc_in.path()
-					<< "\", ignoring...";
+				const unsigned stop = std::min(b.stop, i0 + chunk);
+				trim_ramp.ramp(0, trim_buf.data(), i0, stop - i0);
+				for(unsigned i = i0; i < stop; ++i)
+				{
+					const float trim = trim_buf[i - i0];
+					out.left[i] = trim * gain * in.left[i];
+					out.right[i] = trim * gain * in.right[i];
+//					printf("generating %f, %f\n", gain*l_in, gain*r_in);
+				}
 			}
 		}
 
+		// report the peak of the block back to the host
+		float peak = 0.0f;
 		for(int i = 0; i < buffersize; ++i)
-		{
-			out.left[i] = gain * in.left[i];
-			out.right[i] = gain * in.right[i];
-//			printf("generating %f, %f\n", gain*l_in, gain*r_in);
-		}
+			peak = std::max(peak, std::fabs(out.left[i]));
+		meter.try_write_typed("/peak", peak);
+		trim_ramp.end_block();
 	}
 
 public:	// FEATURE: make these private?
 	virtual ~example_plugin() {}
-	example_plugin() : osc_in(1024) {}
+	example_plugin() :
+		osc_in(1024), meter(256, spa::audio::full_policy_t::coalesce),
+		table(control_name_list, 1, nullptr, 0), trim_ramp(1)
+	{
+		table.bind_control(trim, 0);
+		trim_ramp.set_scale(0, trim.scale_type);
+	}
 
 	bool ui_ext() const override { return false; }
 
 private:
 
+	void init() override
+	{
+		using spa::audio::osc_msg;
+		static const dispatcher_t::entry entries[] = {
+			{ "/gain:f", [](example_plugin& p, const osc_msg& msg,
+				const char* ) { p.gain = msg.arg(0).f; } }
+		};
+		dispatcher.init(entries);
+		trim_buf.resize(std::max<int>(buffersize, 1));
+	}
 	void activate() override {}
 	void deactivate() override {}
 
@@ -79,17 +128,31 @@ private:
 	spa::audio::stereo::out out;
 	buffersize_port buffersize;
 	spa::audio::osc_ringbuffer_in osc_in;
+	spa::audio::osc_ringbuffer_out meter;
+	//! contiguous controls, the host writes them once per block
+	spa::audio::port_table table;
+	spa::audio::control_in<float> trim; //!< view into the table
+	spa::audio::ramp_bank trim_ramp;
+	std::vector<float> trim_buf; //!< trim for a chunk of the block
+
+	using dispatcher_t = spa::audio::osc_dispatcher<example_plugin>;
+	dispatcher_t dispatcher;
 
 	spa::port_ref_base& port(const char* path) override
 	{
-		using p = spa::port_ref_base;
-		switch(path[0])
-		{
-			case 'i': return in;
-			case 'o': return path[1] == 's' ? (p&)osc_in : (p&)out;
-			case 'b': return buffersize;
-			default: throw spa::port_not_found_error(path);
-		}
+		const int index = port_indices.index(path);
+		if(index < 0)
+			throw spa::port_not_found_error(path);
+		return port_at(index);
+	}
+
+	spa::port_ref_base& port_at(unsigned index) override
+	{
+		spa::port_ref_base* const ports[] =
+			{ &in, &out, &buffersize, &osc_in, &meter, &table };
+		if(index >= sizeof(ports) / sizeof(*ports))
+			throw spa::port_not_found_error();
+		return *ports[index];
 	}
 };
 
@@ -117,8 +180,11 @@ public:
 
 	struct port_names_t { const char** names; };
 	spa::simple_vec<spa::simple_str> port_names() const override {
-		return { "in", "out", "buffersize", "osc" };
+		return { port_name_list[0], port_name_list[1], port_name_list[2],
+			port_name_list[3], port_name_list[4], port_name_list[5] };
 	}
+	int port_index(const char* name) const override {
+		return port_indices.index(name); }
 
 	example_plugin* instantiate() const override {
 		return new example_plugin; }
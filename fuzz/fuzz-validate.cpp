@@ -0,0 +1,112 @@
+/*************************************************************************/
+/* fuzz-validate.cpp - fuzzing harness for the OSC validator             */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file fuzz-validate.cpp
+	feeds arbitrary input to the OSC validator and checks that everything
+	it accepts can be parsed without leaving the buffer
+
+	Build with -DFUZZ_LIBFUZZER=ON (clang) for a libFuzzer binary, or use
+	the default build to replay the files of fuzz/corpus.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <rtosc/pseudo-rtosc.h>
+
+using namespace pseudo_rtosc;
+
+static void check(bool ok, const char* what)
+{
+	if(!ok)
+	{
+		std::fprintf(stderr, "fuzz-validate: %s\n", what);
+		std::abort();
+	}
+}
+
+static void check_message(const char* msg, size_t len)
+{
+	check(rtosc_message_length(msg, len) == len, "length mismatch");
+	unsigned nargs = rtosc_narguments(msg);
+	for(unsigned i = 0; i < nargs; ++i)
+		rtosc_argument(msg, i);
+}
+
+static void check_packet(const char* msg, size_t len, int depth)
+{
+	check(depth <= 8, "bundle nested too deep");
+	if(!rtosc_bundle_p(msg))
+		return check_message(msg, len);
+	rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(msg, len);
+	const char* elem;
+	size_t elen;
+	while((elem = rtosc_bundle_itr_next(&itr, &elen)))
+	{
+		check(elem + elen <= msg + len, "bundle element out of bounds");
+		check_packet(elem, elen, depth + 1);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	// copy, so that ASan catches reads past the input
+	std::vector<char> buf(data, data + size);
+	const char* msg = buf.data();
+
+	bool is_msg = rtosc_valid_message_p(msg, size);
+	bool is_packet = rtosc_valid_packet_p(msg, size);
+	check(!is_msg || is_packet, "message valid, but packet not");
+	if(is_packet)
+		check_packet(msg, size, 0);
+
+	const char* packets[] = { msg };
+	const size_t lens[] = { size };
+	bool valid;
+	check(rtosc_valid_packets(packets, lens, 1, &valid) == is_packet
+		&& valid == is_packet, "batch mode differs");
+	return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+//! replays the given corpus files
+int main(int argc, char** argv)
+{
+	for(int i = 1; i < argc; ++i)
+	{
+		std::FILE* fp = std::fopen(argv[i], "rb");
+		if(!fp)
+		{
+			std::fprintf(stderr, "fuzz-validate: can not open %s\n",
+				argv[i]);
+			return 1;
+		}
+		std::vector<uint8_t> input;
+		int c;
+		while((c = std::fgetc(fp)) != EOF)
+			input.push_back(static_cast<uint8_t>(c));
+		std::fclose(fp);
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+	return 0;
+}
+#endif
@@ -254,6 +254,53 @@ int rtosc_itr_end(rtosc_arg_itr_t itr);
  */
 rtosc_arg_t rtosc_argument(const char *msg, unsigned i);
 
+/**
+ * Compute type and position of all arguments in a single pass, such that
+ * they can be accessed using rtosc_argument_at() without scanning the
+ * message again
+ *
+ * @param msg     well formed OSC message
+ * @param types   receives the type of each argument ('[' and ']' skipped)
+ * @param offsets receives the offset of each argument inside msg
+ * @param max     capacity of types and offsets
+ * @returns number of arguments in msg, which can be larger than max
+ */
+unsigned rtosc_argument_offsets(const char *msg, char *types,
+                                uint32_t *offsets, unsigned max);
+
+/**
+ * @param msg    OSC message
+ * @param offset offset of the argument, see rtosc_argument_offsets()
+ * @param type   type of the argument, see rtosc_argument_offsets()
+ * @returns an argument by value via the rtosc_arg_t union
+ */
+rtosc_arg_t rtosc_argument_at(const char *msg, size_t offset, char type);
+
+/**
+ * Decode a run of consecutive float arguments at once
+ *
+ * @param msg  OSC message
+ * @param idx  index of the first float argument
+ * @param dest receives the floats
+ * @param n    capacity of dest
+ * @returns number of floats decoded, which stops at the first argument not
+ *          being a float, or 0 if the message has no argument idx
+ */
+size_t rtosc_argument_floats(const char *msg, unsigned idx,
+                             float *dest, size_t n);
+
+/**
+ * Convert n 32 bit values (e.g. the floats of a blob) between host and OSC
+ * byte order, using SIMD instructions if the compiler flags permit.
+ * dst and src may be equal, but must not overlap otherwise.
+ */
+void rtosc_convert32(void *dst, const void *src, size_t n);
+
+/**
+ * @see rtosc_convert32()
+ */
+void rtosc_convert64(void *dst, const void *src, size_t n);
+
 /**
  * @param msg OSC message
  * @param len Message length upper bound
@@ -275,14 +322,63 @@ typedef struct {
  */
 size_t rtosc_message_ring_length(ring_t *ring);
 
+/**
+ * Write OSC message to a split buffer, e.g. the free space of a ringbuffer
+ *
+ * The message continues in ring[1] once ring[0] is full. Unlike
+ * rtosc_amessage(), the memory is not zeroed on error, and the size can not
+ * be queried by passing NULL.
+ *
+ * @param ring The addresses and lengths of the split buffer
+ * @returns length of resulting message or zero if bounds exceeded
+ * @see rtosc_amessage()
+ */
+size_t rtosc_amessage_ring(ring_t            *ring,
+                           const char        *address,
+                           const char        *arguments,
+                           const rtosc_arg_t *args);
+
+/**
+ * @see rtosc_amessage_ring()
+ */
+size_t rtosc_vmessage_ring(ring_t     *ring,
+                           const char *address,
+                           const char *arguments,
+                           va_list     va);
+
 
 /**
  * Validate if an arbitrary byte sequence is an OSC message.
+ *
+ * The path must be printable, all types must be known, arrays must be
+ * balanced, all padding must be zero and all arguments, including blobs,
+ * must fit into the buffer. The buffer is read only once and never
+ * beyond len.
+ *
  * @param msg pointer to memory buffer
  * @param len length of buffer
+ * @returns true iff the buffer contains exactly one valid message
  */
 bool rtosc_valid_message_p(const char *msg, size_t len);
 
+/**
+ * Like rtosc_valid_message_p(), but also accepts bundles, whose elements
+ * are validated recursively (at most 8 bundles deep, counting the outer one)
+ */
+bool rtosc_valid_packet_p(const char *msg, size_t len);
+
+/**
+ * Validate many packets, e.g. received at once from a socket
+ *
+ * @param packets the packets
+ * @param lens    length of each packet
+ * @param n       number of packets
+ * @param valid   receives for each packet if rtosc_valid_packet_p() holds
+ * @returns number of valid packets
+ */
+size_t rtosc_valid_packets(const char *const *packets, const size_t *lens,
+                           size_t n, bool *valid);
+
 /**
  * @param OSC message
  * @returns the argument string of a given message
@@ -298,9 +394,36 @@ const char *rtosc_argument_string(const char *msg);
  * @param elms   Number of sub messages
  * @param ...    Messages
  * @returns length of generated bundle or zero on failure
+ *
+ * If there is space left, four zero bytes terminate the elements, which are
+ * not included in the returned length.
  */
 size_t rtosc_bundle(char *buffer, size_t len, uint64_t tt, int elms, ...);
 
+typedef struct {
+    const char *pos;  //!< length field of the next element
+    size_t      left; //!< bytes left in the bundle, starting at pos
+} rtosc_bundle_itr_t;
+
+/**
+ * Create an iterator over the elements of a bundle, which walks them in
+ * place in a single forward pass
+ *
+ * @param msg OSC bundle
+ * @param len Upper bound on the length of the bundle
+ * @returns an initialized iterator
+ */
+rtosc_bundle_itr_t rtosc_bundle_itr_begin(const char *msg, size_t len);
+
+/**
+ * Gets the next element of a bundle
+ *
+ * @param itr  bundle iterator
+ * @param size if non-NULL, receives the size of the element in bytes
+ * @returns the next element, or NULL if there are no more elements
+ */
+const char *rtosc_bundle_itr_next(rtosc_bundle_itr_t *itr, size_t *size);
+
 /**
  * Find the elements in a bundle
  *
@@ -313,6 +436,9 @@ size_t rtosc_bundle_elements(const char *msg, size_t len);
 /**
  * Fetch a message within the bundle
  *
+ * This walks all previous elements, prefer rtosc_bundle_itr_next() when
+ * accessing all elements.
+ *
  * @param msg OSC bundle
  * @param i      index of sub-message
  * @returns The ith message within the bundle
@@ -369,5 +495,34 @@ bool rtosc_match(const char *pattern,
 const char *rtosc_match_path(const char *pattern,
                              const char *msg, const char** path_end);
 
+/**
+ * Compile a pattern (see rtosc_match()) into a compact bytecode, so that
+ * matching does not need to parse the pattern string again
+ *
+ * A compiled pattern needs at most 3*strlen(pattern)+2 bytes.
+ *
+ * @param pattern rtosc pattern
+ * @param buffer  receives the compiled pattern
+ * @param len     size of buffer
+ * @returns size of the compiled pattern, or 0 if the pattern is invalid or
+ *          does not fit into the buffer
+ */
+size_t rtosc_pattern_compile(const char *pattern, char *buffer, size_t len);
+
+/**
+ * Like rtosc_match(), for a pattern compiled with rtosc_pattern_compile()
+ *
+ * Does neither allocate nor backtrack.
+ */
+bool rtosc_pattern_match(const char *compiled,
+                         const char *msg, const char** path_end);
+
+/**
+ * Like rtosc_match_path(), for a pattern compiled with
+ * rtosc_pattern_compile(), but only returns whether the path matched
+ */
+bool rtosc_pattern_match_path(const char *compiled,
+                              const char *msg, const char** path_end);
+
 }
 #endif
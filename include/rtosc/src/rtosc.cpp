@@ -6,11 +6,134 @@
 #include <ctype.h>
 #include <assert.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <rtosc/pseudo-rtosc.h>
 #include <rtosc/pseudo-arg-val-math.h>
 
 namespace pseudo_rtosc {
 
+//Conversion between host and OSC (big endian) byte order
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static uint32_t osc_order32(uint32_t x) { return __builtin_bswap32(x); }
+static uint64_t osc_order64(uint64_t x) { return __builtin_bswap64(x); }
+#else
+static uint32_t osc_order32(uint32_t x) { return x; }
+static uint64_t osc_order64(uint64_t x) { return x; }
+#endif
+
+static uint64_t extract_uint64(const uint8_t *arg_pos)
+{
+    uint64_t arg;
+    memcpy(&arg, arg_pos, 8);
+    return osc_order64(arg);
+}
+
+static uint32_t extract_uint32(const uint8_t *arg_pos)
+{
+    uint32_t arg;
+    memcpy(&arg, arg_pos, 4);
+    return osc_order32(arg);
+}
+
+static void emplace_uint64(uint8_t *buffer, uint64_t d)
+{
+    d = osc_order64(d);
+    memcpy(buffer, &d, 8);
+}
+
+static void emplace_uint32(uint8_t *buffer, uint32_t d)
+{
+    d = osc_order32(d);
+    memcpy(buffer, &d, 4);
+}
+
+void rtosc_convert32(void *dst, const void *src, size_t n)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint8_t       *d = (uint8_t*)dst;
+    const uint8_t *s = (const uint8_t*)src;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8,
+        15,14,13,12, 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+    for(; n >= 8; n -= 8, s += 32, d += 32)
+        _mm256_storeu_si256((__m256i*)d, _mm256_shuffle_epi8(
+            _mm256_loadu_si256((const __m256i*)s), mask));
+#elif defined(__SSSE3__)
+    const __m128i mask = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8,
+        15,14,13,12);
+    for(; n >= 4; n -= 4, s += 16, d += 16)
+        _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i*)s), mask));
+#elif defined(__SSE2__)
+    for(; n >= 4; n -= 4, s += 16, d += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)s);
+        //swap the bytes of each 16 bit word, then the words
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2,3,0,1));
+        x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2,3,0,1));
+        _mm_storeu_si128((__m128i*)d, x);
+    }
+#endif
+    for(; n; --n, s += 4, d += 4)
+    {
+        uint32_t x;
+        memcpy(&x, s, 4);
+        x = osc_order32(x);
+        memcpy(d, &x, 4);
+    }
+#else
+    memmove(dst, src, 4*n);
+#endif
+}
+
+void rtosc_convert64(void *dst, const void *src, size_t n)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint8_t       *d = (uint8_t*)dst;
+    const uint8_t *s = (const uint8_t*)src;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_setr_epi8(7,6,5,4,3,2,1,0,
+        15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8);
+    for(; n >= 4; n -= 4, s += 32, d += 32)
+        _mm256_storeu_si256((__m256i*)d, _mm256_shuffle_epi8(
+            _mm256_loadu_si256((const __m256i*)s), mask));
+#elif defined(__SSSE3__)
+    const __m128i mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,
+        15,14,13,12,11,10,9,8);
+    for(; n >= 2; n -= 2, s += 16, d += 16)
+        _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i*)s), mask));
+#elif defined(__SSE2__)
+    for(; n >= 2; n -= 2, s += 16, d += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)s);
+        //swap the bytes of each 16 bit word, then reverse the words
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0,1,2,3));
+        x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0,1,2,3));
+        _mm_storeu_si128((__m128i*)d, x);
+    }
+#endif
+    for(; n; --n, s += 8, d += 8)
+    {
+        uint64_t x;
+        memcpy(&x, s, 8);
+        x = osc_order64(x);
+        memcpy(d, &x, 8);
+    }
+#else
+    memmove(dst, src, 8*n);
+#endif
+}
+
 const char *rtosc_argument_string(const char *msg)
 {
     assert(msg && *msg);
@@ -100,7 +223,7 @@ static unsigned arg_size(const uint8_t *arg_mem, char type)
     if(!has_reserved(type))
         return 0;
     const uint8_t  *arg_pos=arg_mem;
-    uint32_t blob_length = 0;
+    uint32_t blob_length;
     switch(type)
     {
         case 'h':
@@ -119,10 +242,8 @@ static unsigned arg_size(const uint8_t *arg_mem, char type)
             arg_pos += 4-(arg_pos-arg_mem)%4;
             return arg_pos-arg_mem;
         case 'b':
-            blob_length |= (*arg_pos++ << 24);
-            blob_length |= (*arg_pos++ << 16);
-            blob_length |= (*arg_pos++ << 8);
-            blob_length |= (*arg_pos++);
+            blob_length = extract_uint32(arg_pos);
+            arg_pos += 4;
             if(blob_length%4)
                 blob_length += 4-blob_length%4;
             arg_pos += blob_length;
@@ -422,119 +543,209 @@ size_t rtosc_avmessage(char                  *buffer,
     return rtosc_amessage(buffer, len, address, argstr, vals);
 }
 
-size_t rtosc_amessage(char              *buffer,
-                      size_t             len,
-                      const char        *address,
-                      const char        *arguments,
-                      const rtosc_arg_t *args)
+//Cursor of the single pass encoder
+//The destination may consist of two regions, e.g. the free space of a ring
+typedef struct {
+    char  *pos;       //next byte to write
+    size_t left;      //bytes left behind pos
+    char  *next;      //region to continue with once pos runs out
+    size_t next_left; //bytes left in next
+} enc_cursor_t;
+
+//Write across the end of the current region
+static bool enc_write_split(enc_cursor_t *c, const char *src, size_t n)
+{
+    if(n > c->left + c->next_left)
+        return false;
+    if(src) {
+        memcpy(c->pos, src, c->left);
+        src += c->left;
+    }
+    else
+        memset(c->pos, 0, c->left);
+    n -= c->left;
+    c->pos       = c->next;
+    c->left      = c->next_left;
+    c->next      = NULL;
+    c->next_left = 0;
+    if(src)
+        memcpy(c->pos, src, n);
+    else
+        memset(c->pos, 0, n);
+    c->pos  += n;
+    c->left -= n;
+    return true;
+}
+
+//Write @p n bytes from @p src, or zeroes if @p src is NULL
+static bool enc_write(enc_cursor_t *c, const void *src, size_t n)
 {
-    const size_t total_len = vsosc_null(address, arguments, args);
+    if(n > c->left)
+        return enc_write_split(c, (const char*)src, n);
+    if(src)
+        memcpy(c->pos, src, n);
+    else
+        memset(c->pos, 0, n);
+    c->pos  += n;
+    c->left -= n;
+    return true;
+}
 
-    if(!buffer)
-        return total_len;
+//Write the 1..4 NUL bytes that align a string of length @p n
+static bool enc_pad(enc_cursor_t *c, size_t n)
+{
+    static const char zeroes[4] = {0, 0, 0, 0};
+    const size_t pad = 4-n%4;
+    if(c->left < 4)
+        return enc_write(c, NULL, pad);
+    //one 4 byte store; any bytes behind the padding are still inside the
+    //region and either overwritten later or unused
+    memcpy(c->pos, zeroes, 4);
+    c->pos  += pad;
+    c->left -= pad;
+    return true;
+}
 
-    //Abort if the message cannot fit
-    if(total_len>len) {
-        memset(buffer, 0, len);
-        return 0;
-    }
+//Write the characters of @p s without its NUL
+//@param n set to the length of @p s
+static bool enc_chars(enc_cursor_t *c, const char *s, size_t *n)
+{
+    //OSC strings are short, so copy them bytewise instead of calling
+    //strlen and memcpy
+    char *p = c->pos;
+    char *const end = p + c->left;
+    while(*s && p != end)
+        *p++ = *s++;
+    *n      = p - c->pos;
+    c->left = end - p;
+    c->pos  = p;
+    if(!*s)
+        return true;
+    //the current region ran out
+    const size_t rest = strlen(s);
+    *n += rest;
+    return enc_write(c, s, rest);
+}
 
-    memset(buffer, 0, total_len);
+static bool enc_str(enc_cursor_t *c, const char *s)
+{
+    size_t n;
+    return enc_chars(c, s, &n) && enc_pad(c, n);
+}
 
-    unsigned pos = 0;
-    while(*address)
-        buffer[pos++] = *address++;
+static bool enc_uint32(enc_cursor_t *c, uint32_t d)
+{
+    d = osc_order32(d);
+    return enc_write(c, &d, 4);
+}
 
-    //get 32 bit alignment
-    pos += 4-pos%4;
+static bool enc_uint64(enc_cursor_t *c, uint64_t d)
+{
+    d = osc_order64(d);
+    return enc_write(c, &d, 8);
+}
 
-    buffer[pos++] = ',';
+static bool enc_blob(enc_cursor_t *c, rtosc_blob_t b)
+{
+    const size_t n = b.len;
+    return enc_uint32(c, b.len) && enc_write(c, b.data, n) &&
+           (!(n%4) || enc_pad(c, n));
+}
 
-    const char *arg_str = arguments;
-    while(*arg_str)
-        buffer[pos++] = *arg_str++;
+//Encode the message in one walk over the type string
+//@returns false if the cursor ran out of space
+static bool enc_message(enc_cursor_t      *c,
+                        const char        *address,
+                        const char        *arguments,
+                        const rtosc_arg_t *args)
+{
+    static const char comma = ',';
+    if(!enc_str(c, address) || !enc_write(c, &comma, 1))
+        return false;
 
-    pos += 4-pos%4;
+    size_t nargs;
+    if(!enc_chars(c, arguments, &nargs) || !enc_pad(c, nargs+1))
+        return false;
 
-    unsigned toparse = nreserved(arguments);
-    unsigned arg_pos = 0;
-    while(toparse)
+    bool ok = true;
+    for(; ok && *arguments; ++arguments)
     {
-        char arg = *arguments++;
-        assert(arg);
-        int32_t i;
-        int64_t d;
-        const uint8_t *m;
-        const char *s;
-        const unsigned char *u;
-        rtosc_blob_t b;
-        switch(arg) {
+        switch(*arguments) {
             case 'h':
             case 't':
             case 'd':
-                d = args[arg_pos++].t;
-                buffer[pos++] = ((d>>56) & 0xff);
-                buffer[pos++] = ((d>>48) & 0xff);
-                buffer[pos++] = ((d>>40) & 0xff);
-                buffer[pos++] = ((d>>32) & 0xff);
-                buffer[pos++] = ((d>>24) & 0xff);
-                buffer[pos++] = ((d>>16) & 0xff);
-                buffer[pos++] = ((d>>8) & 0xff);
-                buffer[pos++] = (d & 0xff);
-                --toparse;
+                ok = enc_uint64(c, (args++)->t);
                 break;
             case 'r':
             case 'f':
             case 'c':
             case 'i':
-                i = args[arg_pos++].i;
-                buffer[pos++] = ((i>>24) & 0xff);
-                buffer[pos++] = ((i>>16) & 0xff);
-                buffer[pos++] = ((i>>8) & 0xff);
-                buffer[pos++] = (i & 0xff);
-                --toparse;
+                ok = enc_uint32(c, (args++)->i);
                 break;
             case 'm':
                 //TODO verify ordering of spec
-                m = args[arg_pos++].m;
-                buffer[pos++] = m[0];
-                buffer[pos++] = m[1];
-                buffer[pos++] = m[2];
-                buffer[pos++] = m[3];
-                --toparse;
+                ok = enc_write(c, (args++)->m, 4);
                 break;
             case 'S':
             case 's':
-                s = args[arg_pos++].s;
-                while(*s)
-                    buffer[pos++] = *s++;
-                pos += 4-pos%4;
-                --toparse;
+                assert(args->s && "Input strings CANNOT be NULL");
+                ok = enc_str(c, (args++)->s);
                 break;
             case 'b':
-                b = args[arg_pos++].b;
-                i = b.len;
-                buffer[pos++] = ((i>>24) & 0xff);
-                buffer[pos++] = ((i>>16) & 0xff);
-                buffer[pos++] = ((i>>8) & 0xff);
-                buffer[pos++] = (i & 0xff);
-                u = b.data;
-                if(u) {
-                    while(i--)
-                        buffer[pos++] = *u++;
-                }
-                else
-                    pos += i;
-                if(pos%4)
-                    pos += 4-pos%4;
-                --toparse;
+                ok = enc_blob(c, (args++)->b);
                 break;
             default:
                 ;
         }
     }
+    return ok;
+}
 
-    return pos;
+size_t rtosc_amessage(char              *buffer,
+                      size_t             len,
+                      const char        *address,
+                      const char        *arguments,
+                      const rtosc_arg_t *args)
+{
+    if(!buffer)
+        return vsosc_null(address, arguments, args);
+
+    enc_cursor_t c = { buffer, len, NULL, 0 };
+    if(!enc_message(&c, address, arguments, args)) {
+        //Abort if the message cannot fit
+        memset(buffer, 0, len);
+        return 0;
+    }
+    return len - c.left;
+}
+
+size_t rtosc_amessage_ring(ring_t            *ring,
+                           const char        *address,
+                           const char        *arguments,
+                           const rtosc_arg_t *args)
+{
+    enc_cursor_t c = { ring[0].data, ring[0].len, ring[1].data, ring[1].len };
+    if(!enc_message(&c, address, arguments, args))
+        return 0;
+    return ring[0].len + ring[1].len - c.left - c.next_left;
+}
+
+size_t rtosc_vmessage_ring(ring_t     *ring,
+                           const char *address,
+                           const char *arguments,
+                           va_list     ap)
+{
+    const unsigned nargs = nreserved(arguments);
+    if(!nargs)
+        return rtosc_amessage_ring(ring,address,arguments,NULL);
+
+    rtosc_arg_t args[nargs];
+    rtosc_va_list_t ap2;
+    va_copy(ap2.a, ap);
+    rtosc_v2args(args, nargs, arguments, &ap2);
+    va_end(ap2.a);
+
+    return rtosc_amessage_ring(ring,address,arguments,args);
 }
 
 static rtosc_arg_t extract_arg(const uint8_t *arg_pos, char type)
@@ -559,23 +770,13 @@ static rtosc_arg_t extract_arg(const uint8_t *arg_pos, char type)
             case 'h':
             case 't':
             case 'd':
-                result.t |= (((uint64_t)*arg_pos++) << 56);
-                result.t |= (((uint64_t)*arg_pos++) << 48);
-                result.t |= (((uint64_t)*arg_pos++) << 40);
-                result.t |= (((uint64_t)*arg_pos++) << 32);
-                result.t |= (((uint64_t)*arg_pos++) << 24);
-                result.t |= (((uint64_t)*arg_pos++) << 16);
-                result.t |= (((uint64_t)*arg_pos++) << 8);
-                result.t |= (((uint64_t)*arg_pos++));
+                result.t = extract_uint64(arg_pos);
                 break;
             case 'r':
             case 'f':
             case 'c':
             case 'i':
-                result.i |= (*arg_pos++ << 24);
-                result.i |= (*arg_pos++ << 16);
-                result.i |= (*arg_pos++ << 8);
-                result.i |= (*arg_pos++);
+                result.i = extract_uint32(arg_pos);
                 break;
             case 'm':
                 result.m[0] = *arg_pos++;
@@ -584,11 +785,8 @@ static rtosc_arg_t extract_arg(const uint8_t *arg_pos, char type)
                 result.m[3] = *arg_pos++;
                 break;
             case 'b':
-                result.b.len |= (*arg_pos++ << 24);
-                result.b.len |= (*arg_pos++ << 16);
-                result.b.len |= (*arg_pos++ << 8);
-                result.b.len |= (*arg_pos++);
-                result.b.data = (unsigned char *)arg_pos;
+                result.b.len = extract_uint32(arg_pos);
+                result.b.data = (unsigned char *)arg_pos+4;
                 break;
             case 'S':
             case 's':
@@ -646,47 +844,213 @@ rtosc_arg_t rtosc_argument(const char *msg, unsigned idx)
     return extract_arg(arg_mem, type);
 }
 
-static unsigned char deref(unsigned pos, ring_t *ring)
+unsigned rtosc_argument_offsets(const char *msg, char *types,
+                                uint32_t *offsets, unsigned max)
+{
+    const char *args = rtosc_argument_string(msg);
+    unsigned off = arg_start(msg);
+    unsigned nargs = 0;
+    for(; *args; ++args)
+    {
+        if(*args == '[' || *args == ']')
+            continue;
+        if(nargs < max) {
+            types[nargs]   = *args;
+            offsets[nargs] = off;
+        }
+        off += arg_size((const uint8_t*)msg + off, *args);
+        ++nargs;
+    }
+    return nargs;
+}
+
+rtosc_arg_t rtosc_argument_at(const char *msg, size_t offset, char type)
+{
+    return extract_arg((const uint8_t*)msg + offset, type);
+}
+
+size_t rtosc_argument_floats(const char *msg, unsigned idx,
+                             float *dest, size_t n)
+{
+    const char *args = advance_past_dummy_args(rtosc_argument_string(msg));
+    for(unsigned i = idx; i; --i) {
+        if(!*args) //fewer than idx arguments
+            return 0;
+        args = advance_past_dummy_args(args+1);
+    }
+
+    size_t run = 0;
+    while(run < n && args[run] == 'f')
+        ++run;
+    if(run)
+        rtosc_convert32(dest, msg + arg_off(msg, idx), run);
+    return run;
+}
+
+//Index of the first NUL in p[0..len), or len if there is none
+//A word is tested at once. As OSC strings are padded to words, this never
+//reads behind the padding of a string starting at a word boundary.
+static size_t nul_scan(const char *p, size_t len)
+{
+    size_t i = 0;
+    for(; i + 4 <= len; i += 4) {
+        uint32_t w;
+        memcpy(&w, p+i, 4);
+        if((w - 0x01010101u) & ~w & 0x80808080u)
+            break;
+    }
+    while(i < len && p[i])
+        ++i;
+    return i;
+}
+
+static size_t ring_size(const ring_t *ring)
+{
+    return ring[0].len + ring[1].len;
+}
+
+//Index of the first NUL at or behind pos, or the ring size if there is none
+//The ring is only split at the wrap boundary
+static size_t ring_nul(const ring_t *ring, size_t pos)
+{
+    if(pos < ring[0].len) {
+        pos += nul_scan(ring[0].data+pos, ring[0].len-pos);
+        if(pos < ring[0].len)
+            return pos;
+    }
+    if(pos >= ring_size(ring))
+        return ring_size(ring);
+    const size_t pos1 = pos - ring[0].len;
+    return ring[0].len + pos1 + nul_scan(ring[1].data+pos1, ring[1].len-pos1);
+}
+
+//Copy n bytes from pos, with zeroes behind the end of the ring
+static void ring_read(const ring_t *ring, size_t pos, void *dest, size_t n)
+{
+    char *d = (char*)dest;
+    for(int i = 0; i < 2 && n; ++i) {
+        if(pos < ring[i].len) {
+            const size_t n1 = n < ring[i].len-pos ? n : ring[i].len-pos;
+            memcpy(d, ring[i].data+pos, n1);
+            d += n1, n -= n1, pos += n1;
+        }
+        pos -= ring[i].len;
+    }
+    memset(d, 0, n);
+}
+
+static unsigned char deref(size_t pos, const ring_t *ring)
 {
     return pos<ring[0].len ? ring[0].data[pos] :
         ((pos-ring[0].len)<ring[1].len ? ring[1].data[pos-ring[0].len] : 0x00);
 }
 
+static uint32_t ring_uint32(const ring_t *ring, size_t pos)
+{
+    if(pos + 4 <= ring[0].len)
+        return extract_uint32((const uint8_t*)ring[0].data+pos);
+    uint8_t be[4];
+    ring_read(ring, pos, be, 4);
+    return extract_uint32(be);
+}
+
 static size_t bundle_ring_length(ring_t *ring)
 {
-    unsigned pos = 8+8;//goto first length field
+    size_t pos = 8+8;//goto first length field
     uint32_t advance = 0;
     do {
-        advance = deref(pos+0, ring) << (8*3) |
-                  deref(pos+1, ring) << (8*2) |
-                  deref(pos+2, ring) << (8*1) |
-                  deref(pos+3, ring) << (8*0);
+        advance = pos < ring_size(ring) ? ring_uint32(ring, pos) : 0;
         if(advance)
             pos += 4+advance;
     } while(advance);
 
-    return pos <= (ring[0].len+ring[1].len) ? pos : 0;
+    return pos <= ring_size(ring) ? pos : 0;
+}
+
+//rtosc_message_ring_length() for contiguous memory
+static size_t message_length_linear(const char *msg, size_t len)
+{
+    if(len >= 8 && !memcmp(msg, "#bundle", 8)) {
+        ring_t ring[2] = {{(char*)msg, len}, {NULL, 0}};
+        return bundle_ring_length(ring);
+    }
+
+    //Consume path
+    size_t pos = nul_scan(msg, len);
+
+    //Travel through the null word end [1..4] bytes
+    for(int i=0; i<4; ++i)
+        if(++pos < len && msg[pos])
+            break;
+
+    if(pos >= len || msg[pos] != ',')
+        return 0;
+
+    const size_t aligned_pos = pos;
+    const size_t types_end = pos + nul_scan(msg+pos, len-pos);
+    const char *types = msg + pos + 1;
+    pos = types_end + 4-(types_end-aligned_pos)%4;
+
+    for(const char *type = types; type < msg + types_end; ++type)
+    {
+        switch(*type) {
+            case 'h':
+            case 't':
+            case 'd':
+                pos += 8;
+                break;
+            case 'm':
+            case 'r':
+            case 'c':
+            case 'f':
+            case 'i':
+                pos += 4;
+                break;
+            case 'S':
+            case 's':
+                if(pos >= len)
+                    return 0;
+                if(msg[pos])
+                    pos += nul_scan(msg+pos, len-pos);
+                else //empty string, search behind it as the ring version
+                    do ++pos; while(pos < len && msg[pos]);
+                pos += 4-(pos-aligned_pos)%4;
+                break;
+            case 'b':
+                if(pos + 4 > len)
+                    return 0;
+                pos += 4 + extract_uint32((const uint8_t*)msg+pos);
+                if((pos-aligned_pos)%4)
+                    pos += 4-(pos-aligned_pos)%4;
+                break;
+            default:
+                ;
+        }
+    }
+
+    return pos <= len ? pos : 0;
 }
 
 //Zero means no full message present
 size_t rtosc_message_ring_length(ring_t *ring)
 {
+    if(!ring[1].len)
+        return message_length_linear(ring[0].data, ring[0].len);
+
     //Check if the message is a bundle
-    if(deref(0,ring) == '#' &&
-            deref(1,ring) == 'b' &&
-            deref(2,ring) == 'u' &&
-            deref(3,ring) == 'n' &&
-            deref(4,ring) == 'd' &&
-            deref(5,ring) == 'l' &&
-            deref(6,ring) == 'e' &&
-            deref(7,ring) == '\0')
+    char head[8];
+    ring_read(ring, 0, head, 8);
+    if(!memcmp(head, "#bundle", 8))
         return bundle_ring_length(ring);
 
+    //Messages that do not wrap around are parsed without the split
+    const size_t len = message_length_linear(ring[0].data, ring[0].len);
+    if(len)
+        return len;
+
     //Proceed for normal messages
     //Consume path
-    unsigned pos = 0;
-    while(deref(pos++,ring));
-    pos--;
+    size_t pos = ring_nul(ring, 0);
 
     //Travel through the null word end [1..4] bytes
     for(int i=0; i<4; ++i)
@@ -696,24 +1060,20 @@ size_t rtosc_message_ring_length(ring_t *ring)
     if(deref(pos, ring) != ',')
         return 0;
 
-    unsigned aligned_pos = pos;
-    int arguments = pos+1;
-    while(deref(++pos,ring));
-    pos += 4-(pos-aligned_pos)%4;
+    const size_t aligned_pos = pos;
+    size_t arguments = pos+1;
+    const size_t types_end = ring_nul(ring, aligned_pos);
+    pos = types_end + 4-(types_end-aligned_pos)%4;
 
     unsigned toparse = 0;
-    {
-        int arg = arguments-1;
-        while(deref(++arg,ring))
-            toparse += has_reserved(deref(arg,ring));
-    }
+    for(size_t arg = arguments; arg < types_end; ++arg)
+        toparse += has_reserved(deref(arg,ring));
 
     //Take care of varargs
     while(toparse)
     {
         char arg = deref(arguments++,ring);
         assert(arg);
-        uint32_t i;
         switch(arg) {
             case 'h':
             case 't':
@@ -731,17 +1091,14 @@ size_t rtosc_message_ring_length(ring_t *ring)
                 break;
             case 'S':
             case 's':
-                while(deref(++pos,ring));
+                pos = ring_nul(ring, deref(pos, ring) ? pos : pos+1);
                 pos += 4-(pos-aligned_pos)%4;
                 --toparse;
                 break;
             case 'b':
-                i = 0;
-                i |= (deref(pos++,ring) << 24);
-                i |= (deref(pos++,ring) << 16);
-                i |= (deref(pos++,ring) << 8);
-                i |= (deref(pos++,ring));
-                pos += i;
+                if(pos >= ring_size(ring))
+                    return 0;
+                pos += 4 + ring_uint32(ring, pos);
                 if((pos-aligned_pos)%4)
                     pos += 4-(pos-aligned_pos)%4;
                 --toparse;
@@ -752,97 +1109,191 @@ size_t rtosc_message_ring_length(ring_t *ring)
     }
 
 
-    return pos <= (ring[0].len+ring[1].len) ? pos : 0;
+    return pos <= ring_size(ring) ? pos : 0;
 }
 
 size_t rtosc_message_length(const char *msg, size_t len)
 {
-    ring_t ring[2] = {{(char*)msg,len},{NULL,0}};
-    return rtosc_message_ring_length(ring);
+    return message_length_linear(msg, len);
 }
 
-bool rtosc_valid_message_p(const char *msg, size_t len)
+/*
+ * Validation of untrusted data
+ *
+ * All checks happen in one pass, and nothing is read outside of the
+ * buffer.
+ */
+
+enum { VALID_STR_ANY, VALID_STR_PATH };
+
+//Validate a NUL terminated string at msg+pos, which must be zero padded to
+//the next word, and, for VALID_STR_PATH, printable
+//@returns the position behind the padding, or 0 if invalid
+static size_t valid_str(const char *msg, size_t pos, size_t len, int cls)
 {
-    //Validate Path Characters (assumes printable characters are sufficient)
-    if(*msg != '/')
-        return false;
-    const char *tmp = msg;
-    for(unsigned i=0; i<len; ++i) {
-        if(*tmp == 0)
-            break;
-        if(!isprint(*tmp))
-            return false;
-        tmp++;
+    const char  *p    = msg + pos;
+    const size_t left = len - pos;
+    size_t       i    = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo   = _mm_set1_epi8(0x1f);
+    const __m128i hi   = _mm_set1_epi8(0x7f);
+    for(; i + 16 <= left; i += 16) {
+        const __m128i x   = _mm_loadu_si128((const __m128i*)(p+i));
+        const unsigned nul = _mm_movemask_epi8(_mm_cmpeq_epi8(x, zero));
+        if(cls == VALID_STR_PATH) {
+            //bytes > 0x1f and < 0x7f, compared as signed chars
+            const unsigned printable = _mm_movemask_epi8(_mm_and_si128(
+                        _mm_cmpgt_epi8(x, lo), _mm_cmplt_epi8(x, hi)));
+            const unsigned before_nul = nul ? (nul & -nul) - 1 : 0xffff;
+            if(~printable & before_nul)
+                return 0;
+        }
+        if(nul) {
+            i += __builtin_ctz(nul);
+            goto found;
+        }
     }
+#endif
+    for(; i < left && p[i]; ++i)
+        if(cls == VALID_STR_PATH && (p[i] < 0x20 || p[i] > 0x7e))
+            return 0;
+    if(i == left)
+        return 0;
+#if defined(__SSE2__)
+found:
+#endif
+    pos += i + 1;
+    const size_t end = (pos + 3) & ~(size_t)3;
+    if(end > len)
+        return 0;
+    for(; pos < end; ++pos)
+        if(msg[pos])
+            return 0;
+    return end;
+}
 
-    //tmp is now either pointing to a null or the end of the string
-    const size_t offset1 = tmp-msg;
-    size_t       offset2 = tmp-msg;
-    for(; offset2<len; offset2++) {
-        if(*tmp == ',')
-            break;
-        tmp++;
+//@returns the length of the message at msg, or 0 if invalid
+static size_t valid_message(const char *msg, size_t len)
+{
+    if(len < 8 || *msg != '/')
+        return 0;
+    size_t pos = valid_str(msg, 0, len, VALID_STR_PATH);
+    if(!pos || pos >= len || msg[pos] != ',')
+        return 0;
+
+    const char *type = msg + pos + 1;
+    if(!(pos = valid_str(msg, pos, len, VALID_STR_ANY)))
+        return 0;
+
+    unsigned depth = 0;
+    for(; *type; ++type) {
+        size_t size = 0;
+        switch(*type) {
+            case 'h':
+            case 't':
+            case 'd':
+                size = 8;
+                break;
+            case 'm':
+            case 'r':
+            case 'c':
+            case 'f':
+            case 'i':
+                size = 4;
+                break;
+            case 'T':
+            case 'F':
+            case 'N':
+            case 'I':
+                break;
+            case '[':
+                ++depth;
+                break;
+            case ']':
+                if(!depth--)
+                    return 0;
+                break;
+            case 'S':
+            case 's':
+                if(pos >= len || !(pos = valid_str(msg, pos, len,
+                                                   VALID_STR_ANY)))
+                    return 0;
+                break;
+            case 'b':
+            {
+                if(len - pos < 4)
+                    return 0;
+                const size_t blob = extract_uint32((const uint8_t*)msg+pos);
+                if(blob > len - pos - 4)
+                    return 0;
+                pos += 4 + blob;
+                for(; pos % 4; ++pos)
+                    if(pos >= len || msg[pos])
+                        return 0;
+                break;
+            }
+            default:
+                return 0;
+        }
+        if(size > len - pos)
+            return 0;
+        pos += size;
     }
+    return depth ? 0 : pos;
+}
 
-    //Too many NULL bytes
-    if(offset2-offset1 > 4)
-        return false;
+static bool valid_packet(const char *msg, size_t len, unsigned depth);
 
-    if((offset2 % 4) != 0)
+//@returns whether msg is a bundle of exactly len bytes with valid elements
+static bool valid_bundle(const char *msg, size_t len, unsigned depth)
+{
+    if(len < 16 || memcmp(msg, "#bundle", 8) || depth >= 8)
         return false;
-
-    size_t observed_length = rtosc_message_length(msg, len);
-    return observed_length == len;
+    for(size_t pos = 16; pos < len;) {
+        if(len - pos < 4)
+            return false;
+        const size_t size = extract_uint32((const uint8_t*)msg+pos);
+        pos += 4;
+        if(!size || size % 4 || size > len - pos ||
+           !valid_packet(msg+pos, size, depth+1))
+            return false;
+        pos += size;
+    }
+    return true;
 }
-static uint64_t extract_uint64(const uint8_t *arg_pos)
+
+static bool valid_packet(const char *msg, size_t len, unsigned depth)
 {
-    uint64_t arg = 0;
-    arg |= (((uint64_t)*arg_pos++) << 56);
-    arg |= (((uint64_t)*arg_pos++) << 48);
-    arg |= (((uint64_t)*arg_pos++) << 40);
-    arg |= (((uint64_t)*arg_pos++) << 32);
-    arg |= (((uint64_t)*arg_pos++) << 24);
-    arg |= (((uint64_t)*arg_pos++) << 16);
-    arg |= (((uint64_t)*arg_pos++) << 8);
-    arg |= (((uint64_t)*arg_pos++));
-    return arg;
+    return (len && *msg == '#') ? valid_bundle(msg, len, depth)
+                                : (len && valid_message(msg, len) == len);
 }
 
-static uint32_t extract_uint32(const uint8_t *arg_pos)
+bool rtosc_valid_message_p(const char *msg, size_t len)
 {
-    uint32_t arg = 0;
-    arg |= (((uint32_t)*arg_pos++) << 24);
-    arg |= (((uint32_t)*arg_pos++) << 16);
-    arg |= (((uint32_t)*arg_pos++) << 8);
-    arg |= (((uint32_t)*arg_pos++));
-    return arg;
+    return len && valid_message(msg, len) == len;
 }
 
-static void emplace_uint64(uint8_t *buffer, uint64_t d)
+bool rtosc_valid_packet_p(const char *msg, size_t len)
 {
-    buffer[0] = ((d>>56) & 0xff);
-    buffer[1] = ((d>>48) & 0xff);
-    buffer[2] = ((d>>40) & 0xff);
-    buffer[3] = ((d>>32) & 0xff);
-    buffer[4] = ((d>>24) & 0xff);
-    buffer[5] = ((d>>16) & 0xff);
-    buffer[6] = ((d>>8)  & 0xff);
-    buffer[7] = ((d>>0)  & 0xff);
+    return valid_packet(msg, len, 0);
 }
 
-static void emplace_uint32(uint8_t *buffer, uint32_t d)
+size_t rtosc_valid_packets(const char *const *packets, const size_t *lens,
+                           size_t n, bool *valid)
 {
-    buffer[0] = ((d>>24) & 0xff);
-    buffer[1] = ((d>>16) & 0xff);
-    buffer[2] = ((d>>8)  & 0xff);
-    buffer[3] = ((d>>0)  & 0xff);
+    size_t n_valid = 0;
+    for(size_t i = 0; i < n; ++i)
+        n_valid += (valid[i] = valid_packet(packets[i], lens[i], 0));
+    return n_valid;
 }
 
 size_t rtosc_bundle(char *buffer, size_t len, uint64_t tt, int elms, ...)
 {
     char *_buffer = buffer;
-    memset(buffer, 0, len);
-    strcpy(buffer, "#bundle");
+    if(len < 16)
+        return 0;
+    memcpy(buffer, "#bundle", 8);
     buffer += 8;
     emplace_uint64((uint8_t*)buffer, tt);
     buffer += 8;
@@ -852,6 +1303,10 @@ size_t rtosc_bundle(char *buffer, size_t len, uint64_t tt, int elms, ...)
         const char   *msg  = va_arg(va, const char*);
         //It is assumed that any passed message/bundle is valid
         size_t        size = rtosc_message_length(msg, -1);
+        if((size_t)(buffer-_buffer) + 4 + size > len) {
+            va_end(va);
+            return 0;
+        }
         emplace_uint32((uint8_t*)buffer, size);
         buffer += 4;
         memcpy(buffer, msg, size);
@@ -859,49 +1314,59 @@ size_t rtosc_bundle(char *buffer, size_t len, uint64_t tt, int elms, ...)
     }
     va_end(va);
 
+    //terminate the element list if possible, for readers without length
+    if((size_t)(buffer-_buffer) + 4 <= len)
+        memset(buffer, 0, 4);
+
     return buffer-_buffer;
 }
 
+rtosc_bundle_itr_t rtosc_bundle_itr_begin(const char *msg, size_t len)
+{
+    rtosc_bundle_itr_t itr;
+    itr.pos  = msg + 16;
+    itr.left = len < 16 ? 0 : len - 16;
+    return itr;
+}
+
+const char *rtosc_bundle_itr_next(rtosc_bundle_itr_t *itr, size_t *size)
+{
+    if(itr->left < 4)
+        return NULL;
+    const size_t elm_size = extract_uint32((const uint8_t*)itr->pos);
+    if(!elm_size || elm_size > itr->left - 4)
+        return NULL;
+    const char *elm = itr->pos + 4;
+    itr->pos  += 4 + elm_size;
+    itr->left -= 4 + elm_size;
+    if(size)
+        *size = elm_size;
+    return elm;
+}
 
-#define POS ((size_t)(((const char *)lengths) - buffer))
 size_t rtosc_bundle_elements(const char *buffer, size_t len)
 {
-    const uint32_t *lengths = (const uint32_t*) (buffer+16);
+    rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(buffer, len);
     size_t elms = 0;
-    while(POS < len && extract_uint32((const uint8_t*)lengths)) {
-        lengths += extract_uint32((const uint8_t*)lengths)/4+1;
-
-        if(POS > len)
-            break;
+    while(rtosc_bundle_itr_next(&itr, NULL))
         ++elms;
-    }
     return elms;
 }
-#undef POS
 
 const char *rtosc_bundle_fetch(const char *buffer, unsigned elm)
 {
-    const uint32_t *lengths = (const uint32_t*) (buffer+16);
-    size_t elm_pos = 0;
-    while(elm_pos!=elm && extract_uint32((const uint8_t*)lengths)) {
-        ++elm_pos;
-        lengths += extract_uint32((const uint8_t*)lengths)/4+1;
-    }
-
-    return (const char*) (elm==elm_pos?lengths+1:NULL);
+    rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(buffer, (size_t)-1);
+    const char *msg;
+    while((msg = rtosc_bundle_itr_next(&itr, NULL)) && elm--);
+    return msg;
 }
 
 size_t rtosc_bundle_size(const char *buffer, unsigned elm)
 {
-    const uint32_t *lengths = (const uint32_t*) (buffer+16);
-    size_t elm_pos = 0;
-    size_t last_len = 0;
-    while(elm_pos!=elm && extract_uint32((const uint8_t*)lengths)) {
-        last_len = extract_uint32((const uint8_t*)lengths);
-        ++elm_pos, lengths+=extract_uint32((const uint8_t*)lengths)/4+1;
-    }
-
-    return last_len;
+    rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(buffer, (size_t)-1);
+    size_t size = 0;
+    while(rtosc_bundle_itr_next(&itr, &size) && elm--);
+    return elm == (unsigned)-1 ? size : 0;
 }
 
 int rtosc_bundle_p(const char *msg)
@@ -914,4 +1379,184 @@ uint64_t rtosc_bundle_timetag(const char *msg)
     return extract_uint64((const uint8_t*)msg+8);
 }
 
+
+/*
+ * Pattern matching
+ *
+ * A pattern is split into ops, which are either interpreted directly from
+ * the pattern string (rtosc_match) or serialized once into a compact
+ * bytecode (rtosc_pattern_compile):
+ *   'l' <len:1> <chars:len>   literal chars
+ *   '#' <max:4>               digit run with value < max
+ *   '/'                       end of path, message continues with '/'
+ *   '$'                       end of path, message ends
+ * followed by the NUL terminated argument restrictors (":f:ii" or "").
+ */
+
+typedef struct
+{
+    char        type;
+    uint32_t    num; //literal length or range maximum
+    const char *lit;
+} pattern_op_t;
+
+//Parse the next op from a pattern string, false on syntax errors
+static bool next_pattern_op(const char **pattern, pattern_op_t *op)
+{
+    const char *p = *pattern;
+    if(*p == '#') {
+        if(!isdigit(*++p))
+            return false;
+        uint64_t max = 0;
+        for(; isdigit(*p); ++p)
+            if((max = max*10 + (*p-'0')) > 0xffffffff)
+                return false;
+        op->type = '#';
+        op->num  = max;
+    } else if(*p == '/' && (!p[1] || p[1] == ':')) {
+        op->type = '/';
+        ++p;
+    } else if(!*p || *p == ':') {
+        op->type = '$';
+    } else {
+        op->type = 'l';
+        op->lit  = p;
+        while(*p && *p != '#' && *p != ':' && p-op->lit < 255 &&
+              !(*p == '/' && (!p[1] || p[1] == ':')))
+            ++p;
+        op->num  = p - op->lit;
+    }
+    *pattern = p;
+    return true;
+}
+
+//Match one op, returning the advanced message path or NULL
+static const char *match_pattern_op(const pattern_op_t *op,
+                                    const char *msg)
+{
+    switch(op->type)
+    {
+        case 'l':
+            return strncmp(msg, op->lit, op->num) ? NULL : msg + op->num;
+        case '#':
+        {
+            if(!isdigit(*msg))
+                return NULL;
+            uint64_t val = 0;
+            for(; isdigit(*msg); ++msg)
+                if((val = val*10 + (*msg-'0')) >= op->num)
+                    return NULL;
+            return msg;
+        }
+        case '/':
+            return *msg == '/' ? msg : NULL;
+        default:
+            return *msg ? NULL : msg;
+    }
+}
+
+//Match the restrictors (e.g. ":f:ii", "::i") against a type string
+static bool match_pattern_args(const char *args, const char *types)
+{
+    if(*args != ':')
+        return true;
+    while(*args == ':') {
+        const char *t = types;
+        for(++args; *args && *args != ':' && *args == *t; ++args, ++t);
+        if((!*args || *args == ':') && !*t)
+            return true;
+        while(*args && *args != ':')
+            ++args;
+    }
+    return false;
+}
+
+const char *rtosc_match_path(const char *pattern,
+                             const char *msg, const char** path_end)
+{
+    pattern_op_t op;
+    do {
+        if(!next_pattern_op(&pattern, &op) ||
+           !(msg = match_pattern_op(&op, msg)))
+            return NULL;
+    } while(op.type == 'l' || op.type == '#');
+
+    if(path_end)
+        *path_end = msg;
+    return pattern;
+}
+
+bool rtosc_match(const char *pattern,
+                 const char *msg, const char** path_end)
+{
+    const char *args = rtosc_match_path(pattern, msg, path_end);
+    return args && match_pattern_args(args, rtosc_argument_string(msg));
+}
+
+size_t rtosc_pattern_compile(const char *pattern, char *buffer, size_t len)
+{
+    pattern_op_t op;
+    size_t pos = 0;
+    do {
+        if(!next_pattern_op(&pattern, &op))
+            return 0;
+        size_t size = op.type == 'l' ? 2 + op.num :
+                      op.type == '#' ? 5 : 1;
+        if(pos + size > len)
+            return 0;
+        buffer[pos] = op.type;
+        if(op.type == 'l') {
+            buffer[pos+1] = (char)op.num;
+            memcpy(buffer+pos+2, op.lit, op.num);
+        } else if(op.type == '#')
+            memcpy(buffer+pos+1, &op.num, 4);
+        pos += size;
+    } while(op.type == 'l' || op.type == '#');
+
+    size_t args_len = strlen(pattern) + 1;
+    if(pos + args_len > len)
+        return 0;
+    memcpy(buffer+pos, pattern, args_len);
+    return pos + args_len;
+}
+
+//Match the path ops of a compiled pattern, returning its restrictors
+static const char *match_compiled_path(const char *compiled,
+                                       const char *msg,
+                                       const char **path_end)
+{
+    pattern_op_t op;
+    do {
+        op.type = *compiled;
+        if(op.type == 'l') {
+            op.num = (unsigned char)compiled[1];
+            op.lit = compiled + 2;
+            compiled += 2 + op.num;
+        } else if(op.type == '#') {
+            memcpy(&op.num, compiled+1, 4);
+            compiled += 5;
+        } else
+            ++compiled;
+        if(!(msg = match_pattern_op(&op, msg)))
+            return NULL;
+    } while(op.type == 'l' || op.type == '#');
+
+    if(path_end)
+        *path_end = msg;
+    return compiled;
+}
+
+bool rtosc_pattern_match_path(const char *compiled,
+                              const char *msg, const char** path_end)
+{
+    return match_compiled_path(compiled, msg, path_end);
+}
+
+bool rtosc_pattern_match(const char *compiled,
+                         const char *msg, const char** path_end)
+{
+    const char *args = match_compiled_path(compiled, msg, path_end);
+    return args && match_pattern_args(args, rtosc_argument_string(msg));
+}
+
 }
@@ -35,6 +35,8 @@
 #ifndef SPA_AUDIO_H
 #define SPA_AUDIO_H
 
+#include <utility> // only std::swap
+#include <cmath>   // only std::pow for ramps
 #include <rtosc/pseudo-rtosc.h>
 
 #include "spa.h"
@@ -58,6 +60,16 @@ public:
 		args_found(args_found) {}
 };
 
+//! an OSC pattern could not be parsed
+class invalid_pattern_error : public error_base
+{
+public:
+	const char* pattern;
+	invalid_pattern_error(const char* pattern) :
+		error_base("invalid OSC pattern"),
+		pattern(pattern) {}
+};
+
 // assertions that throw errors
 
 //! let the plugin assert that the types supplied in a message for a port
@@ -159,36 +171,1224 @@ class buffersize : public virtual control_in<int> {
 	SPA_OBJECT
 };
 
+//! Flat port layout: all float control values of a plugin in one
+//! contiguous block, and all audio buffer pointers in another. The host
+//! updates either block with one memcpy per block, and the plugin reads
+//! them without pointer chasing through the port objects.
+//! Control values may be written from another thread than run(): the
+//! host stages them and publishes them once per block, and the plugin
+//! fetches them at the start of run(). So all controls of one block come
+//! from one consistent snapshot, without atomics per value.
+//! The table is a port itself, the host gets it through visiting. Legacy
+//! ports can be bound to the table as views into it; they must not be
+//! listed in descriptor::port_names() then, since the table owns them.
+//! The plugin allocates the table, e.g. in its constructor.
+class port_table : public virtual port_ref_base
+{
+	float* values; //!< the fetched snapshot, bound ports point here
+	unsigned nvalues;
+	snapshot_block<float> snapshots;
+	const char* const* value_names;
+	float** buffers;
+	unsigned nbuffers;
+	const char* const* buffer_names;
+
+	//! legacy audio ports bound to a buffer, at most one is non-null
+	struct buffer_view
+	{
+		port_ref<const float>* in;
+		port_ref<float>* out;
+	};
+	buffer_view* views;
+
+	int directions() const override { return direction_t::input; }
+public:
+	SPA_OBJECT
+
+	//! @param control_names names of the @p ncontrols control values
+	//! @param buffer_names names of the @p nbuffers audio buffers
+	//! Both name arrays must outlive the table.
+	port_table(const char* const* control_names, unsigned ncontrols,
+		const char* const* buffer_names, unsigned nbuffers) :
+		values(new float[ncontrols]()), nvalues(ncontrols),
+		snapshots(ncontrols),
+		value_names(control_names),
+		buffers(new float*[nbuffers]()), nbuffers(nbuffers),
+		buffer_names(buffer_names),
+		views(new buffer_view[nbuffers]()) {}
+	port_table(const port_table& ) = delete;
+	port_table& operator=(const port_table& ) = delete;
+	~port_table() { delete[] values; delete[] buffers; delete[] views; }
+
+	unsigned control_count() const { return nvalues; }
+	unsigned buffer_count() const { return nbuffers; }
+	const char* control_name(unsigned i) const { return value_names[i]; }
+	const char* buffer_name(unsigned i) const { return buffer_names[i]; }
+
+	//! read control value @p i (plugin side)
+	float control(unsigned i) const { return values[i]; }
+	//! all control values, contiguous
+	const float* controls() const { return values; }
+	//! read buffer pointer @p i (plugin side)
+	float* buffer(unsigned i) const { return buffers[i]; }
+
+	//! stage all control_count() values from @p src (host side)
+	void write_controls(const float* src) {
+		std::memcpy(snapshots.stage(), src, nvalues * sizeof(float)); }
+	//! stage one control value (host side)
+	void write_control(unsigned i, float value) {
+		snapshots.stage()[i] = value; }
+	//! make the staged control values visible to the next
+	//! fetch_controls() at once (host side, once per block)
+	void publish_controls() { snapshots.publish(); }
+	//! load the latest published control values, if any, into the
+	//! block that control() and bound ports read (plugin side, at the
+	//! start of run())
+	void fetch_controls()
+	{
+		if(snapshots.fetch())
+			std::memcpy(values, snapshots.read(),
+				nvalues * sizeof(float));
+	}
+	//! set all buffer_count() buffer pointers from @p src (host side)
+	//! bound legacy ports are updated, too
+	void write_buffers(float* const* src)
+	{
+		std::memcpy(buffers, src, nbuffers * sizeof(float*));
+		for(unsigned i = 0; i < nbuffers; ++i)
+		{
+			if(views[i].in)
+				views[i].in->set_ref(buffers[i]);
+			else if(views[i].out)
+				views[i].out->set_ref(buffers[i]);
+		}
+	}
+
+	//! make the control port @p p a view of control value @p i
+	void bind_control(port_ref<const float>& p, unsigned i) {
+		p.set_ref(values + i); }
+	//! make the audio input @p p follow buffer pointer @p i
+	void bind_buffer(port_ref<const float>& p, unsigned i) {
+		views[i].in = &p, views[i].out = nullptr, p.set_ref(buffers[i]); }
+	//! make the audio output @p p follow buffer pointer @p i
+	void bind_buffer(port_ref<float>& p, unsigned i) {
+		views[i].out = &p, views[i].in = nullptr, p.set_ref(buffers[i]); }
+};
+
+//! Smooths many float controls at once: each block, every control whose
+//! target changed ramps from its old to its new value, so plugins do
+//! not click on control changes. Linear controls ramp linearly,
+//! logarithmic ones (scale_type_t::logartihmic) exponentially, i.e.
+//! linearly on a logarithmic scale.
+//! All state is kept in arrays over the controls, and only the
+//! controls that change in a block are touched after begin_block(), so
+//! thousands of controls cost little if few of them move. Ramps are
+//! computed without per-sample dependencies on the previous sample,
+//! which lets the compiler vectorize them.
+//! Usage per block: set_target() or set_targets() (e.g. from a
+//! port_table or from OSC events), begin_block(), then ramp() or
+//! coefficient() for the controls in use, and end_block(). Targets must
+//! not change between begin_block() and end_block().
+class ramp_bank
+{
+	unsigned n;
+	float* cur; //!< values at the start of the block
+	float* target; //!< values at the end of the block
+	float* step; //!< added resp. multiplied per sample
+	unsigned char* log_scale; //!< whether to ramp exponentially
+	unsigned char* mult; //!< whether step is a factor in this block
+	unsigned* changing; //!< indices of controls ramping in this block
+	unsigned nchanging = 0;
+	unsigned frames = 0;
+
+	//! number of lanes for exponential ramps
+	static constexpr unsigned lanes = 8;
+public:
+	//! @param n number of controls, all linear and 0 at first
+	ramp_bank(unsigned n) :
+		n(n), cur(new float[n]()), target(new float[n]()),
+		step(new float[n]()), log_scale(new unsigned char[n]()),
+		mult(new unsigned char[n]()), changing(new unsigned[n]) {}
+	ramp_bank(const ramp_bank& ) = delete;
+	ramp_bank& operator=(const ramp_bank& ) = delete;
+	~ramp_bank()
+	{
+		delete[] cur; delete[] target; delete[] step;
+		delete[] log_scale; delete[] mult; delete[] changing;
+	}
+
+	unsigned size() const { return n; }
+
+	//! set the scale of control @p i, e.g. from control_in::scale_type
+	void set_scale(unsigned i, scale_type_t scale) {
+		log_scale[i] = (scale == scale_type_t::logartihmic); }
+	//! set control @p i to @p value immediately, without ramp
+	void reset(unsigned i, float value) { cur[i] = target[i] = value; }
+	//! let control @p i ramp to @p value during the next block
+	void set_target(unsigned i, float value) { target[i] = value; }
+	//! set the targets of all size() controls from @p values
+	void set_targets(const float* values) {
+		std::memcpy(target, values, n * sizeof(float)); }
+
+	//! compute the ramps for the next @p nframes samples
+	void begin_block(unsigned nframes)
+	{
+		frames = nframes;
+		nchanging = 0;
+		if(!nframes)
+			return;
+		const float inv = 1.0f / nframes;
+		for(unsigned i = 0; i < n; ++i)
+		{
+			if(target[i] == cur[i])
+				continue;
+			changing[nchanging++] = i;
+			// exponential ramps can not cross or touch 0
+			mult[i] = log_scale[i] && (cur[i] > 0) == (target[i] > 0)
+				&& cur[i] != 0 && target[i] != 0;
+			step[i] = mult[i] ? std::pow(target[i] / cur[i], inv)
+				: (target[i] - cur[i]) * inv;
+		}
+	}
+	//! make the targets the current values
+	void end_block()
+	{
+		for(unsigned k = 0; k < nchanging; ++k)
+			cur[changing[k]] = target[changing[k]];
+		nchanging = 0;
+	}
+
+	//! number of controls ramping in this block
+	unsigned changing_count() const { return nchanging; }
+	//! indices of the controls ramping in this block
+	const unsigned* changing_controls() const { return changing; }
+
+	//! value of control @p i at the start of the block
+	float value(unsigned i) const { return cur[i]; }
+	//! whether control @p i ramps in this block
+	bool is_changing(unsigned i) const { return cur[i] != target[i]; }
+	//! whether coefficient() is a factor (exponential ramp) rather than
+	//! an increment (linear ramp)
+	bool multiplicative(unsigned i) const {
+		return is_changing(i) && mult[i]; }
+	//! per-sample increment or factor of control @p i, for plugins that
+	//! advance the value themselves, starting at value()
+	float coefficient(unsigned i) const {
+		return is_changing(i) ? step[i] : 0.0f; }
+
+	//! write the values of control @p i for each sample of the block,
+	//! i.e. begin_block()'s @p nframes values, into @p out; the last one
+	//! is the target
+	void ramp(unsigned i, float* out) const { ramp(i, out, 0, frames); }
+
+	//! like ramp(i, out), but only write the @p count values starting at
+	//! sample @p first into @p out[0] to @p out[count - 1], so plugins
+	//! can ramp a block in chunks of a fixed buffer
+	void ramp(unsigned i, float* out, unsigned first, unsigned count) const
+	{
+		const float c = cur[i], s = step[i];
+		if(first >= frames || !count)
+			return;
+		if(count > frames - first)
+			count = frames - first;
+		if(!is_changing(i))
+		{
+			for(unsigned k = 0; k < count; ++k)
+				out[k] = c;
+		}
+		else if(!mult[i])
+		{
+			for(unsigned k = 0; k < count; ++k)
+				out[k] = c + s * (first + k + 1);
+		}
+		else
+		{
+			// lane j holds the value of sample first + k + j, and all
+			// lanes advance by s^lanes per iteration
+			float lane[lanes], stride = s;
+			lane[0] = first ? c * std::pow(s, (float)(first + 1)) : c * s;
+			for(unsigned j = 1; j < lanes; ++j)
+				lane[j] = lane[j - 1] * s, stride *= s;
+			unsigned k = 0;
+			for(; k + lanes <= count; k += lanes)
+			{
+				for(unsigned j = 0; j < lanes; ++j)
+					out[k + j] = lane[j], lane[j] *= stride;
+			}
+			for(unsigned j = 0; j < lanes && k + j < count; ++j)
+				out[k + j] = lane[j];
+		}
+		if(first + count == frames)
+			out[count - 1] = target[i];
+	}
+};
+
+namespace detail {
+
+//! convert between host and OSC (big endian) byte order
+inline uint32_t osc_byte_order(uint32_t x)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap32(x);
+#else
+	return x;
+#endif
+}
+
+//! @copydoc osc_byte_order(uint32_t)
+inline uint64_t osc_byte_order(uint64_t x)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap64(x);
+#else
+	return x;
+#endif
+}
+
+//! store @p value as @p Bits bit OSC argument at @p dest
+template<class Bits, class T>
+char* put_arg(char* dest, T value)
+{
+	Bits bits;
+	std::memcpy(&bits, &value, sizeof(Bits));
+	bits = osc_byte_order(bits);
+	std::memcpy(dest, &bits, sizeof(Bits));
+	return dest + sizeof(Bits);
+}
+
+//! OSC type traits for the C++ type @p T, used by the typed writes
+template<class T> struct osc_arg;
+
+template<> struct osc_arg<int32_t> {
+	static constexpr char tag = 'i';
+	static constexpr std::size_t size(int32_t) { return 4; }
+	static char* put(char* dest, int32_t i) {
+		return put_arg<uint32_t>(dest, i); }
+	static pseudo_rtosc::rtosc_arg_t arg(int32_t i) {
+		pseudo_rtosc::rtosc_arg_t a; a.i = i; return a; }
+};
+
+template<> struct osc_arg<int64_t> {
+	static constexpr char tag = 'h';
+	static constexpr std::size_t size(int64_t) { return 8; }
+	static char* put(char* dest, int64_t h) {
+		return put_arg<uint64_t>(dest, h); }
+	static pseudo_rtosc::rtosc_arg_t arg(int64_t h) {
+		pseudo_rtosc::rtosc_arg_t a; a.h = h; return a; }
+};
+
+template<> struct osc_arg<float> {
+	static constexpr char tag = 'f';
+	static constexpr std::size_t size(float) { return 4; }
+	static char* put(char* dest, float f) {
+		return put_arg<uint32_t>(dest, f); }
+	static pseudo_rtosc::rtosc_arg_t arg(float f) {
+		pseudo_rtosc::rtosc_arg_t a; a.f = f; return a; }
+};
+
+template<> struct osc_arg<double> {
+	static constexpr char tag = 'd';
+	static constexpr std::size_t size(double) { return 8; }
+	static char* put(char* dest, double d) {
+		return put_arg<uint64_t>(dest, d); }
+	static pseudo_rtosc::rtosc_arg_t arg(double d) {
+		pseudo_rtosc::rtosc_arg_t a; a.d = d; return a; }
+};
+
+template<> struct osc_arg<const char*> {
+	static constexpr char tag = 's';
+	static std::size_t size(const char* s) {
+		return (std::strlen(s) & ~(std::size_t)3) + 4; }
+	static char* put(char* dest, const char* s)
+	{
+		const std::size_t len = std::strlen(s), padded = size(s);
+		std::memcpy(dest, s, len);
+		std::memset(dest + len, 0, padded - len);
+		return dest + padded;
+	}
+	static pseudo_rtosc::rtosc_arg_t arg(const char* s) {
+		pseudo_rtosc::rtosc_arg_t a; a.s = s; return a; }
+};
+
+template<> struct osc_arg<char*> : public osc_arg<const char*> {};
+
+//! comma, type tags and padding of a message with arguments @p Args
+template<class ...Args>
+struct osc_type_block
+{
+	//! size, including the comma and 1..4 NUL bytes
+	static constexpr std::size_t size = (sizeof...(Args) + 1) / 4 * 4 + 4;
+	static constexpr char value[size] = { ',', osc_arg<Args>::tag... };
+};
+
+template<class ...Args>
+constexpr char osc_type_block<Args...>::value[];
+
+inline std::size_t args_size() { return 0; }
+
+//! size of all arguments, constant for fixed size types
+template<class First, class ...More>
+std::size_t args_size(First first, More... more) {
+	return osc_arg<First>::size(first) + args_size(more...); }
+
+//! size of the message encoded by encode_typed(), without the header
+template<class ...Args>
+std::size_t typed_size(const char* dest, Args... args)
+{
+	return (std::strlen(dest) & ~(std::size_t)3) + 4
+		+ osc_type_block<Args...>::size + args_size(args...);
+}
+
+//! Encode a message into @p free, behind a 4 byte length field. Apart
+//! from the path, no part of the message needs to be computed at runtime.
+//! @return the number of bytes used, or 0 if the message did not fit
+template<class ...Args>
+std::size_t encode_typed(const ring_region& free, uint32_t frame,
+	const char* dest, Args... args)
+{
+	using types = osc_type_block<Args...>;
+	const std::size_t header = ringbuffer<char>::header_size(frame);
+	const std::size_t dest_len = std::strlen(dest);
+	const std::size_t path_size = (dest_len & ~(std::size_t)3) + 4;
+	const std::size_t len = typed_size(dest, args...);
+	if(free.size() < len + header)
+		return 0;
+
+	if(free.first_size >= len + header)
+	{
+		char* pos = free.first + header;
+		std::memcpy(pos, dest, dest_len);
+		std::memset(pos + dest_len, 0, path_size - dest_len);
+		pos += path_size;
+		std::memcpy(pos, types::value, types::size);
+		pos += types::size;
+		int expand[] = { 0, (pos = osc_arg<Args>::put(pos, args), 0)... };
+		(void)expand;
+	}
+	else
+	{
+		// the message wraps around the ringbuffer's end
+		const ring_region body = free.sub(header);
+		pseudo_rtosc::ring_t ring[2] = {
+			{ body.first, body.first_size },
+			{ body.second, body.second_size } };
+		const pseudo_rtosc::rtosc_arg_t rtosc_args[] = {
+			pseudo_rtosc::rtosc_arg_t(), osc_arg<Args>::arg(args)... };
+		pseudo_rtosc::rtosc_amessage_ring(ring, dest, types::value + 1,
+			rtosc_args + 1);
+	}
+	ringbuffer<char>::put_header(free, len, frame);
+	return len + header;
+}
+
+} // namespace detail
+
+//! A message with fixed path, type string and argument sizes, which is
+//! encoded once, e.g. for automation. Sending it only requires patching
+//! the arguments and copying the whole frame into the ringbuffer.
+class osc_msg_template
+{
+	//! 4 byte length field, followed by the message
+	char* frame;
+	std::size_t frame_size;
+	//! offset of each argument inside frame
+	std::size_t* offsets;
+	//! the type string inside frame
+	const char* types;
+	unsigned nargs;
+
+	static std::size_t fixed_size(char type)
+	{
+		switch(type)
+		{
+			case 'h': case 't': case 'd': return 8;
+			case 'i': case 'f': case 'c': case 'r': case 'm': return 4;
+			case 'T': case 'F': case 'N': case 'I': return 0;
+			default: return (std::size_t)-1;
+		}
+	}
+
+public:
+	//! @throw invalid_args_error if @p types contains types without fixed
+	//!   size, like strings or blobs
+	osc_msg_template(const char* path, const char* types) :
+		frame(nullptr), frame_size(0),
+		offsets(new std::size_t[std::strlen(types) + 1]),
+		types(nullptr), nargs(0)
+	{
+		std::size_t args_size = 0;
+		for(const char* t = types; *t; ++t, ++nargs)
+		{
+			const std::size_t sz = fixed_size(*t);
+			if(sz == (std::size_t)-1)
+			{
+				delete[] offsets;
+				throw invalid_args_error(path, types);
+			}
+			offsets[nargs] = args_size;
+			args_size += sz;
+		}
+
+		// all arguments are being zeroed initially
+		pseudo_rtosc::rtosc_arg_t* zeroes =
+			new pseudo_rtosc::rtosc_arg_t[nargs + 1]();
+		const std::size_t len = pseudo_rtosc::rtosc_amessage(nullptr, 0,
+			path, types, zeroes);
+		frame_size = len + 4;
+		frame = new char[frame_size];
+		ring_region(frame, 4).put_length(len);
+		pseudo_rtosc::rtosc_amessage(frame + 4, len, path, types, zeroes);
+		delete[] zeroes;
+		this->types = pseudo_rtosc::rtosc_argument_string(frame + 4);
+
+		for(unsigned i = 0; i < nargs; ++i)
+			offsets[i] += frame_size - args_size;
+	}
+	osc_msg_template(const osc_msg_template& ) = delete;
+	~osc_msg_template() { delete[] frame; delete[] offsets; }
+
+	//! set argument @p i, which must have the type matching @p T
+	//! (int32_t, int64_t, float or double)
+	//! @throw out_of_range_error if there is no argument @p i
+	//! @throw invalid_args_error if argument @p i has another type
+	template<class T>
+	void set(unsigned i, T value)
+	{
+		static_assert(detail::osc_arg<T>::tag != 's',
+			"message templates only have fixed size arguments");
+		if(i >= nargs)
+			throw out_of_range_error(i, nargs);
+		if(types[i] != detail::osc_arg<T>::tag)
+			throw invalid_args_error(frame + 4, types);
+		detail::osc_arg<T>::put(frame + offsets[i], value);
+	}
+
+	//! the length field, followed by the message
+	const char* data() const { return frame; }
+	//! size of data()
+	std::size_t size() const { return frame_size; }
+};
+
+namespace detail {
+
+//! encode the message directly into the free ringbuffer memory
+//! @p free, behind its header (see ringbuffer<char>::put_header())
+//! @return the number of bytes used, or 0 if the message did not fit
+inline std::size_t encode(const ring_region& free, uint32_t frame,
+	const char *dest, const char *args, va_list va)
+{
+	const std::size_t header = ringbuffer<char>::header_size(frame);
+	if(free.size() <= header)
+		return 0;
+	const ring_region body = free.sub(header);
+	pseudo_rtosc::ring_t ring[2] = {
+		{ body.first, body.first_size },
+		{ body.second, body.second_size } };
+	const size_t len =
+		pseudo_rtosc::rtosc_vmessage_ring(ring, dest, args, va);
+	if(len)
+		ringbuffer<char>::put_header(free, len, frame);
+	return len ? len + header : 0;
+}
+
+//! size of the message encoded by encode(), without the header
+inline std::size_t encoded_size(const char *dest, const char *args,
+	va_list va)
+{
+	va_list va2;
+	va_copy(va2, va);
+	const std::size_t len =
+		pseudo_rtosc::rtosc_vmessage(nullptr, 0, dest, args, va2);
+	va_end(va2);
+	return len;
+}
+
+//! copy the message of @p msg behind a header for @p frame
+inline std::size_t copy(const ring_region& free, uint32_t frame,
+	const osc_msg_template& msg)
+{
+	const std::size_t header = ringbuffer<char>::header_size(frame),
+		len = msg.size() - 4;
+	if(free.size() < header + len)
+		return 0;
+	ringbuffer<char>::put_header(free, len, frame);
+	free.sub(header).copy_from(msg.data() + 4, len);
+	return header + len;
+}
+
+} // namespace detail
+
 //! ringbuffer instance for the host
 class osc_ringbuffer : public ringbuffer<char>
 {
 	using base = ringbuffer<char>;
+
+	//! let @p encode write a message into the free memory, and publish
+	//! it, or handle the overflow according to the overflow policy
+	//! @param size returns the size of the message, only for statistics
+	template<class Encode, class Size>
+	bool write_encoded(Encode encode, Size size)
+	{
+		std::size_t used;
+		unsigned waited = 0;
+		while(!(used = encode(reserve(write_space()))) &&
+			wait_for_space(waited)) ;
+		if(used)
+			commit(used);
+		else
+			count_drop(1, size());
+		return used;
+	}
 public:
-	void write(const char *dest, const char *args, ...)
+	//! write a message, if there is enough space (see
+	//! set_overflow_policy())
+	//! @return false iff the message has been dropped
+	bool write(const char *dest, const char *args, ...)
+	{
+		va_list va;
+		va_start(va,args);
+		const bool res = write_at(0, dest, args, va);
+		va_end(va);
+		return res;
+	}
+	bool write(const char *dest, const char *args, va_list va) {
+		return write_at(0, dest, args, va); }
+
+	//! Like write(), but the message shall be processed at frame
+	//! @p frame of the plugin's next block (see split_block)
+	bool write_at(uint32_t frame, const char *dest, const char *args, ...)
 	{
 		va_list va;
 		va_start(va,args);
-		write(dest, args, va);
+		const bool res = write_at(frame, dest, args, va);
 		va_end(va);
+		return res;
 	}
-	void write(const char *dest, const char *args, va_list va)
+	bool write_at(uint32_t frame, const char *dest, const char *args,
+		va_list va)
 	{
 		// TODO: => move to cpp file
 		// TODO: check iwyu?
-		const size_t len =
-		pseudo_rtosc::rtosc_vmessage(write_buffer, max_msg,
-			dest, args, va);
+		return write_encoded([&](const ring_region& free) {
+				return detail::encode(free, frame, dest, args, va); },
+			[&]() { return detail::encoded_size(dest, args, va); });
+	}
 
-		write_with_length(write_buffer, len);
+	//! Write a message with the argument types derived from the C++ types
+	//! of @p args (int32_t, int64_t, float, double, const char*), e.g.
+	//! write_typed("/gain", 0.5f). No type string is parsed at runtime.
+	template<class ...Args>
+	bool write_typed(const char *dest, Args... args) {
+		return write_typed_at(0, dest, args...); }
+
+	//! @see write_typed(), write_at()
+	template<class ...Args>
+	bool write_typed_at(uint32_t frame, const char *dest, Args... args)
+	{
+		return write_encoded([&](const ring_region& free) {
+				return detail::encode_typed(free, frame, dest,
+					args...); },
+			[&]() { return detail::typed_size(dest, args...); });
 	}
 
-	osc_ringbuffer(std::size_t size, int max_msg = 1024) :
-		base(size),
-		max_msg(max_msg), write_buffer(new char[max_msg]) {}
-	~osc_ringbuffer() { delete[] write_buffer; }
-	private:
-	std::size_t max_msg;
-	char* write_buffer;
+	//! write the message @p msg, with its current arguments
+	bool write(const osc_msg_template& msg) {
+		return base::write(msg.data(), msg.size()); }
+
+	//! @see write(const osc_msg_template&), write_at()
+	bool write_at(uint32_t frame, const osc_msg_template& msg)
+	{
+		return write_encoded([&](const ring_region& free) {
+				return detail::copy(free, frame, msg); },
+			[&]() { return msg.size() - 4; });
+	}
+
+	//! Writes multiple messages, which are all published at once by
+	//! commit() (or by the destructor). If one message does not fit,
+	//! none of the messages is published.
+	class transaction
+	{
+	protected:
+		osc_ringbuffer& rb;
+		const ring_region free; //!< all free memory at construction
+		std::size_t used = 0;
+		std::size_t msgs = 0; //!< number of messages written
+		bool ok = true, done = false;
+
+		void add(std::size_t len) { used += len; ok = len; }
+	public:
+		void write(const char *dest, const char *args, ...)
+		{
+			va_list va;
+			va_start(va,args);
+			write_at(0, dest, args, va);
+			va_end(va);
+		}
+		void write(const char *dest, const char *args, va_list va) {
+			write_at(0, dest, args, va); }
+
+		//! @see osc_ringbuffer::write_at()
+		void write_at(uint32_t frame, const char *dest,
+			const char *args, ...)
+		{
+			va_list va;
+			va_start(va,args);
+			write_at(frame, dest, args, va);
+			va_end(va);
+		}
+		void write_at(uint32_t frame, const char *dest,
+			const char *args, va_list va)
+		{
+			++msgs;
+			if(ok)
+				add(detail::encode(free.sub(used), frame, dest, args,
+					va));
+		}
+
+		//! @see osc_ringbuffer::write_typed()
+		template<class ...Args>
+		void write_typed(const char *dest, Args... args) {
+			write_typed_at(0, dest, args...); }
+
+		//! @see osc_ringbuffer::write_typed_at()
+		template<class ...Args>
+		void write_typed_at(uint32_t frame, const char *dest,
+			Args... args)
+		{
+			++msgs;
+			if(ok)
+				add(detail::encode_typed(free.sub(used), frame,
+					dest, args...));
+		}
+
+		//! @see osc_ringbuffer::write(const osc_msg_template&)
+		void write(const osc_msg_template& msg) { write_at(0, msg); }
+
+		//! @see osc_ringbuffer::write_at(uint32_t,
+		//!   const osc_msg_template&)
+		void write_at(uint32_t frame, const osc_msg_template& msg)
+		{
+			++msgs;
+			if(ok)
+				add(detail::copy(free.sub(used), frame, msg));
+		}
+
+		//! publish all messages written so far
+		//! @return false iff a message did not fit, in which case
+		//!   nothing has been published and all messages count as
+		//!   dropped (transactions never block)
+		bool commit()
+		{
+			if(!done)
+			{
+				if(!ok)
+					rb.count_drop(msgs, used);
+				else if(used)
+					rb.commit(used);
+			}
+			done = true;
+			return ok;
+		}
+
+		//! discard all messages written so far: nothing is published,
+		//!   and nothing counts as dropped; later writes are ignored,
+		//!   and commit() returns false
+		void rollback() { ok = false, done = true; }
+
+		transaction(osc_ringbuffer& rb) :
+			rb(rb), free(rb.reserve(rb.write_space())) {}
+		~transaction() { commit(); }
+	};
+
+	//! Writes multiple messages as elements of one OSC bundle. They are
+	//! encoded in place behind the bundle header, and the bundle is
+	//! published as one message by commit() (or by the destructor). If
+	//! one message does not fit, the bundle is not published.
+	class bundle : private transaction
+	{
+		const uint32_t frame;
+		//! size of the header in the ringbuffer
+		const std::size_t header;
+	public:
+		using transaction::write;
+		using transaction::write_typed;
+		using transaction::rollback;
+
+		//! publish the bundle, unless it is empty
+		//! @return false iff a message did not fit, in which case
+		//!   nothing has been published
+		bool commit()
+		{
+			if(ok && !done)
+			{
+				if(used == header + 16)
+					used = 0;
+				else
+					put_header(free, used - header, frame);
+			}
+			return transaction::commit();
+		}
+
+		//! @param timetag the OSC time tag of the bundle
+		//! @param frame see osc_ringbuffer::write_at()
+		bundle(osc_ringbuffer& rb, uint64_t timetag, uint32_t frame = 0) :
+			transaction(rb), frame(frame), header(header_size(frame))
+		{
+			if((ok = (free.size() >= header + 16)))
+			{
+				char head[16] = "#bundle";
+				timetag = detail::osc_byte_order(timetag);
+				std::memcpy(head + 8, &timetag, 8);
+				free.sub(header).copy_from(head, 16);
+				used = header + 16;
+			}
+		}
+		~bundle() { commit(); }
+	};
+
+	osc_ringbuffer(std::size_t size) : base(size) {}
+};
+
+//! ringbuffer instance for hosts which write from multiple threads,
+//! e.g. a sequencer, a UI and a network thread. All writes are lock-free
+//! and can happen concurrently; the plugin reads it like osc_ringbuffer
+//! (see mpsc_ringbuffer). Messages of different threads are read in the
+//! order in which their space was reserved.
+class osc_mpsc_ringbuffer : public mpsc_ringbuffer
+{
+	using base = mpsc_ringbuffer;
+
+	//! reserve @p len bytes plus the header, let @p encode fill them, and
+	//! publish them
+	//! @return false iff the message has been dropped
+	template<class Encode>
+	bool write_reserved(std::size_t len, uint32_t frame, Encode encode)
+	{
+		if(!len)
+		{
+			count_drop(1, 0);
+			return false;
+		}
+		const std::size_t n = len + header_size(frame);
+		std::size_t pos;
+		const ring_region r = reserve_or_drop(n, pos);
+		if(!r.size())
+			return false;
+		encode(r);
+		commit_shared(pos, n);
+		return true;
+	}
+public:
+	//! @see osc_ringbuffer::write()
+	bool write(const char *dest, const char *args, ...)
+	{
+		va_list va;
+		va_start(va,args);
+		const bool res = write_at(0, dest, args, va);
+		va_end(va);
+		return res;
+	}
+	bool write(const char *dest, const char *args, va_list va) {
+		return write_at(0, dest, args, va); }
+
+	//! @see osc_ringbuffer::write_at()
+	bool write_at(uint32_t frame, const char *dest, const char *args, ...)
+	{
+		va_list va;
+		va_start(va,args);
+		const bool res = write_at(frame, dest, args, va);
+		va_end(va);
+		return res;
+	}
+	bool write_at(uint32_t frame, const char *dest, const char *args,
+		va_list va)
+	{
+		// the space must be known before reserving it
+		return write_reserved(detail::encoded_size(dest, args, va), frame,
+			[&](const ring_region& r) {
+				detail::encode(r, frame, dest, args, va); });
+	}
+
+	//! @see osc_ringbuffer::write_typed()
+	template<class ...Args>
+	bool write_typed(const char *dest, Args... args) {
+		return write_typed_at(0, dest, args...); }
+
+	//! @see osc_ringbuffer::write_typed_at()
+	template<class ...Args>
+	bool write_typed_at(uint32_t frame, const char *dest, Args... args)
+	{
+		return write_reserved(detail::typed_size(dest, args...), frame,
+			[&](const ring_region& r) {
+				detail::encode_typed(r, frame, dest, args...); });
+	}
+
+	//! @see osc_ringbuffer::write(const osc_msg_template&)
+	bool write(const osc_msg_template& msg) { return write_at(0, msg); }
+
+	//! @see osc_ringbuffer::write_at(uint32_t, const osc_msg_template&)
+	bool write_at(uint32_t frame, const osc_msg_template& msg)
+	{
+		return write_reserved(msg.size() - 4, frame,
+			[&](const ring_region& r) { detail::copy(r, frame, msg); });
+	}
+
+	osc_mpsc_ringbuffer(std::size_t size) : base(size) {}
+};
+
+//! view on an OSC message, e.g. inside an osc_ringbuffer_in
+//! the argument types and positions are computed once on construction,
+//! so accessing types and arguments does not scan the message
+class osc_msg
+{
+public:
+	//! number of arguments that can be accessed in O(1)
+	static constexpr unsigned max_table_args = 8;
+private:
+	const char* msg;
+	const char* type_str;
+	uint32_t frame_offset;
+	uint32_t msg_size;
+	unsigned nargs;
+	char arg_types[max_table_args];
+	uint32_t offsets[max_table_args];
+public:
+	const char* path() const { return msg; }
+	const char* types() const { return type_str; }
+	//! frame of the current block at which the message shall be processed
+	uint32_t frame() const { return frame_offset; }
+	//! size of the message in bytes
+	uint32_t size() const { return msg_size; }
+
+	//! whether this is a bundle, whose messages are in elements()
+	bool is_bundle() const { return msg && *msg == '#'; }
+	//! the messages of a bundle, walked in place
+	osc_bundle_range elements() const;
+	//! time tag of a bundle
+	uint64_t timetag() const {
+		return pseudo_rtosc::rtosc_bundle_timetag(msg); }
+	//! number of arguments, without '[' and ']'
+	unsigned narguments() const { return nargs; }
+	//! argument @p i, or out_of_range_error if there is none
+	pseudo_rtosc::rtosc_arg_t arg(unsigned i) const
+	{
+		if(i >= nargs)
+			throw out_of_range_error(i, nargs);
+		return (i < max_table_args)
+			? pseudo_rtosc::rtosc_argument_at(msg, offsets[i],
+				arg_types[i])
+			: pseudo_rtosc::rtosc_argument(msg, i);
+	}
+	//! decode up to @p n consecutive float args, starting at arg @p first
+	//! @return number of floats written to @p dest
+	std::size_t arg_floats(unsigned first, float* dest, std::size_t n) const
+	{
+		return (first >= nargs ||
+			(first < max_table_args && arg_types[first] != 'f'))
+			? 0
+			: pseudo_rtosc::rtosc_argument_floats(msg, first, dest, n);
+	}
+
+	//! @param size size of @p msg, only required for bundles
+	osc_msg(const char* msg = nullptr, uint32_t frame = 0,
+		uint32_t size = 0) :
+		msg(msg),
+		type_str(!msg ? nullptr : is_bundle() ? ""
+			: pseudo_rtosc::rtosc_argument_string(msg)),
+		frame_offset(frame),
+		msg_size(size),
+		nargs((!msg || is_bundle()) ? 0
+			: pseudo_rtosc::rtosc_argument_offsets(msg,
+				arg_types, offsets, max_table_args)) {}
+};
+
+//! the messages of a bundle, see osc_msg::elements()
+class osc_bundle_range
+{
+	pseudo_rtosc::rtosc_bundle_itr_t first;
+	uint32_t frame;
+public:
+	class iterator
+	{
+		pseudo_rtosc::rtosc_bundle_itr_t itr;
+		uint32_t frame;
+		osc_msg cur;
+	public:
+		const osc_msg& operator*() const { return cur; }
+		const osc_msg* operator->() const { return &cur; }
+		iterator& operator++()
+		{
+			std::size_t size;
+			const char* msg =
+				pseudo_rtosc::rtosc_bundle_itr_next(&itr, &size);
+			cur = osc_msg(msg, frame, msg ? size : 0);
+			return *this;
+		}
+		bool operator!=(const iterator& other) const {
+			return cur.path() != other.cur.path(); }
+		iterator(const pseudo_rtosc::rtosc_bundle_itr_t& itr,
+			uint32_t frame) : itr(itr), frame(frame) {}
+	};
+	iterator begin() const { return ++iterator(first, frame); }
+	iterator end() const { return iterator(first, frame); }
+
+	osc_bundle_range(const osc_msg& bundle) :
+		first(pseudo_rtosc::rtosc_bundle_itr_begin(bundle.path(),
+			bundle.size())),
+		frame(bundle.frame()) {}
+};
+
+inline osc_bundle_range osc_msg::elements() const {
+	return osc_bundle_range(*this); }
+
+//! range of OSC messages, see osc_ringbuffer_in::read_all()
+class osc_msg_range
+{
+	const osc_msg *_begin, *_end;
+public:
+	const osc_msg* begin() const { return _begin; }
+	const osc_msg* end() const { return _end; }
+	std::size_t size() const { return _end - _begin; }
+	osc_msg_range(const osc_msg* begin, const osc_msg* end) :
+		_begin(begin), _end(end) {}
+};
+
+//! a part of a block, and the OSC events that must be applied before
+//! processing it, see split_block
+struct sub_block
+{
+	osc_msg_range events; //!< events at frame start
+	unsigned start, stop; //!< frames [start, stop) of the block
+};
+
+//! Splits a block of @p nframes frames into sub-blocks at the frames of
+//! the messages @p msgs, for sample accurate automation:
+//! @code
+//!   for(const sub_block& b : split_block(osc_in.read_all(), buffersize))
+//!   {
+//!   	for(const osc_msg& msg : b.events)
+//!   		dispatcher.dispatch(*this, msg);
+//!   	for(unsigned i = b.start; i < b.stop; ++i)
+//!   		// ...
+//!   }
+//! @endcode
+//! Messages are expected in order of their frames. Frames before the
+//! previous message's frame are applied at that frame, and frames beyond
+//! the block are applied at its last frame.
+class split_block
+{
+	osc_msg_range msgs;
+	unsigned nframes;
+public:
+	class iterator
+	{
+		friend class split_block;
+		const osc_msg* end;
+		unsigned nframes;
+		sub_block cur;
+
+		unsigned frame_of(const osc_msg* m) const
+		{
+			const unsigned f = m->frame();
+			return f < cur.start ? cur.start
+				: f < nframes ? f : nframes - 1;
+		}
+		//! find the sub-block starting at cur.start
+		void next(const osc_msg* pos)
+		{
+			const osc_msg* ev_end = pos;
+			for(; ev_end != end && frame_of(ev_end) == cur.start;
+				++ev_end) ;
+			cur.events = osc_msg_range(pos, ev_end);
+			cur.stop = (ev_end == end) ? nframes : frame_of(ev_end);
+		}
+		iterator(const osc_msg* begin, const osc_msg* end,
+			unsigned nframes, unsigned start) :
+			end(end), nframes(nframes),
+			cur { osc_msg_range(begin, begin), start, start }
+		{
+			if(start < nframes)
+				next(begin);
+		}
+	public:
+		const sub_block& operator*() const { return cur; }
+		const sub_block* operator->() const { return &cur; }
+		iterator& operator++()
+		{
+			cur.start = cur.stop;
+			if(cur.start < nframes)
+				next(cur.events.end());
+			return *this;
+		}
+		bool operator!=(const iterator& other) const {
+			return cur.start != other.cur.start; }
+	};
+
+	iterator begin() const {
+		return iterator(msgs.begin(), msgs.end(), nframes, 0); }
+	iterator end() const {
+		return iterator(msgs.end(), msgs.end(), nframes, nframes); }
+
+	split_block(const osc_msg_range& msgs, unsigned nframes) :
+		msgs(msgs), nframes(nframes) {}
+};
+
+//! Table of the latest value per path and type string, for automation
+//! that the host may produce faster than the plugin consumes it, e.g.
+//! high resolution gain ramps. The host overwrites a parameter's pending
+//! message instead of queuing every intermediate value, and the plugin
+//! reads only the freshest values once per block, using
+//! osc_ringbuffer_in::read_latest(). Discrete events, like note ons,
+//! must still be written to the osc_ringbuffer.
+//! There must be exactly one writer and one reader. Each slot is guarded
+//! by a sequence lock, so neither side ever waits for the other.
+class osc_latest_table
+{
+	struct slot
+	{
+		//! odd while the writer is changing the slot
+		std::atomic<uint32_t> seq;
+		//! 4 byte length field, followed by the message, or 0 if unused
+		char* msg;
+	};
+
+	const std::size_t nslots; //!< a power of 2
+	const std::size_t max_msg;
+	char* const mem; //!< nslots buffers of max_msg bytes
+	slot* const slots;
+
+	// reader side
+	char* const copies; //!< nslots buffers of max_msg bytes
+	uint32_t* const read_seq; //!< sequence number of the last read
+	osc_msg* const latest; //!< messages of the last read()
+
+	static std::size_t round_up_pow2(std::size_t n)
+	{
+		std::size_t res = 1;
+		for(; res < n; res <<= 1) ;
+		return res;
+	}
+
+	//! find the slot for the key @p dest and @p types, or a free one
+	//! @return the slot, or nullptr if the table is full
+	slot* find(const char* dest, const char* types)
+	{
+		// FNV-1a over the key
+		uint32_t hash = 2166136261u;
+		for(const char* c = dest; *c; ++c)
+			hash = (hash ^ (unsigned char)*c) * 16777619u;
+		for(const char* c = types; *c; ++c)
+			hash = (hash ^ (unsigned char)*c) * 16777619u;
+
+		for(std::size_t i = 0; i < nslots; ++i)
+		{
+			slot& sl = slots[(hash + i) & (nslots - 1)];
+			const char* msg = sl.msg + 4;
+			if(!ring_region(sl.msg, 4).get_length() ||
+				(!std::strcmp(msg, dest) && !std::strcmp(types,
+				pseudo_rtosc::rtosc_argument_string(msg))))
+				return &sl;
+		}
+		return nullptr;
+	}
+
+	//! replace the message of the key @p dest and @p types by the one
+	//! that @p encode writes
+	template<class Encode>
+	bool write_encoded(const char* dest, const char* types,
+		std::size_t len, Encode encode)
+	{
+		slot* sl = (len && len + 4 <= max_msg) ? find(dest, types)
+			: nullptr;
+		if(!sl)
+			return false;
+		const uint32_t seq = sl->seq.load(std::memory_order_relaxed);
+		sl->seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		encode(ring_region(sl->msg, max_msg));
+		sl->seq.store(seq + 2, std::memory_order_release);
+		return true;
+	}
+public:
+	//! Set the latest value of the parameter @p dest with type string
+	//! @p types. Must only be called by the writer.
+	//! @return false if the table is full or the message is larger than
+	//!   the slots, in which case it should be written to the ringbuffer
+	bool write(const char *dest, const char *types, ...)
+	{
+		va_list va;
+		va_start(va,types);
+		const bool res = write(dest, types, va);
+		va_end(va);
+		return res;
+	}
+	bool write(const char *dest, const char *types, va_list va)
+	{
+		return write_encoded(dest, types,
+			detail::encoded_size(dest, types, va),
+			[&](const ring_region& r) {
+				detail::encode(r, 0, dest, types, va); });
+	}
+
+	//! @see write(), osc_ringbuffer::write_typed()
+	template<class ...Args>
+	bool write_typed(const char *dest, Args... args)
+	{
+		return write_encoded(dest,
+			detail::osc_type_block<Args...>::value + 1,
+			detail::typed_size(dest, args...),
+			[&](const ring_region& r) {
+				detail::encode_typed(r, 0, dest, args...); });
+	}
+
+	//! Return the messages that have been written since the last call.
+	//! They are copied, so they stay valid until the next call, and
+	//! their frame is 0. Must only be called by the reader.
+	//! A slot which is just being written is skipped until the next call.
+	osc_msg_range read()
+	{
+		std::size_t n = 0;
+		for(std::size_t i = 0; i < nslots; ++i)
+		{
+			const slot& sl = slots[i];
+			const uint32_t seq = sl.seq.load(std::memory_order_acquire);
+			if(seq == read_seq[i] || (seq & 1))
+				continue;
+			char* copy = copies + i * max_msg;
+			std::memcpy(copy, sl.msg, max_msg);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(sl.seq.load(std::memory_order_relaxed) != seq)
+				continue;
+			read_seq[i] = seq;
+			latest[n++] = osc_msg(copy + 4, 0,
+				ring_region(copy, 4).get_length());
+		}
+		return osc_msg_range(latest, latest + n);
+	}
+
+	//! @param nslots maximum number of parameters (rounded up to a
+	//!   power of 2)
+	//! @param max_msg maximum size of each message, including 4 bytes
+	osc_latest_table(std::size_t nslots, std::size_t max_msg = 64) :
+		nslots(round_up_pow2(nslots)), max_msg(max_msg),
+		mem(new char[this->nslots * max_msg]()),
+		slots(new slot[this->nslots]),
+		copies(new char[this->nslots * max_msg]),
+		read_seq(new uint32_t[this->nslots]()),
+		latest(new osc_msg[this->nslots])
+	{
+		for(std::size_t i = 0; i < this->nslots; ++i)
+		{
+			slots[i].seq.store(0, std::memory_order_relaxed);
+			slots[i].msg = mem + i * max_msg;
+		}
+	}
+	osc_latest_table(const osc_latest_table& ) = delete;
+	~osc_latest_table()
+	{
+		delete[] mem; delete[] slots; delete[] copies;
+		delete[] read_seq; delete[] latest;
+	}
 };
 
 //! ringbuffer in port for plugins to reference a host ringbuffer
@@ -197,39 +1397,647 @@ class osc_ringbuffer_in : public ringbuffer_in<char>
 public:
 	SPA_OBJECT
 	using base = ringbuffer_in<char>;
-	osc_ringbuffer_in(std::size_t s, int max_msg = 1024) :
+	osc_ringbuffer_in(std::size_t s, int max_msg = 1024,
+		int max_batch = 64) :
 		base(s),
-		max_msg(max_msg), read_buffer(new char[max_msg]) {}
-	~osc_ringbuffer_in() { delete[] read_buffer; }
+		max_msg(max_msg), read_buffer(new char[max_msg]),
+		max_batch(max_batch), batch(new osc_msg[max_batch]) {}
+	~osc_ringbuffer_in() { delete[] read_buffer; delete[] batch; }
 
-	//! read the next message into temporary buffer
+	//! make the next message available, usually without copying it
+	//! the previous message is being released
 	//! @return true iff there was a next message;
-	bool read_msg() { return base::read_msg(read_buffer, max_msg); }
+	bool read_msg()
+	{
+		uint32_t frame, length;
+		const char* next = base::view_msg(read_buffer, max_msg, &frame,
+			&length);
+		msg = next ? osc_msg(next, frame, length) : osc_msg();
+		return next;
+	}
+
+	const char* path() const { return msg.path(); }
+	const char* types() const { return msg.types(); }
+	uint32_t frame() const { return msg.frame(); }
+	pseudo_rtosc::rtosc_arg_t arg(unsigned i) const { return msg.arg(i); }
+
+	//! make all messages that are currently in the ringbuffer (but at most
+	//! max_batch) available at once, usually without copying them
+	//! the previous messages are being released
+	osc_msg_range read_all() {
+		return osc_msg_range(batch, batch + base::view_msgs(batch,
+			max_batch, read_buffer, max_msg)); }
+
+	//! connect to the host's table of latest automation values, which
+	//! read_latest() returns
+	void connect(osc_latest_table& table) { latest = &table; }
+	using base::connect;
 
-	const char* path() const { return read_buffer; }
-	const char* types() const { return pseudo_rtosc::rtosc_argument_string(
-		read_buffer); }
-	pseudo_rtosc::rtosc_arg_t arg(unsigned i) const { return
-		pseudo_rtosc::rtosc_argument(read_buffer, i); }
+	//! Return the automation values that the host has written to the
+	//! osc_latest_table since the last call, one per parameter. They
+	//! should be applied before the messages of read_all().
+	osc_msg_range read_latest() {
+		return latest ? latest->read() : osc_msg_range(nullptr, nullptr); }
+
+	//! call @p f(const osc_msg&) for all messages until the ringbuffer is
+	//! empty, e.g. for a host reading the ringbuffer of an
+	//! osc_ringbuffer_out
+	//! @return the number of messages
+	template<class F>
+	std::size_t drain(F f)
+	{
+		std::size_t n = 0, batch_size;
+		do {
+			const osc_msg_range r = read_all();
+			for(const osc_msg& m : r)
+				f(m);
+			n += (batch_size = r.size());
+		} while(batch_size);
+		return n;
+	}
 
 	// TODO: private?!
 	std::size_t max_msg;
+	//! only used for messages that wrap around the ringbuffer's end
 	char* read_buffer; // TODO: smash?
+	//! the current message, either inside the ringbuffer or read_buffer
+	osc_msg msg;
+	std::size_t max_batch;
+	osc_msg* batch; //!< messages of the last read_all()
+	osc_latest_table* latest = nullptr;
+};
+
+//! what osc_ringbuffer_out does with messages that do not fit into the
+//! ringbuffer
+enum class full_policy_t
+{
+	drop, //!< drop the message
+	//! keep the latest message per path and type string in a small
+	//! table, and write them as soon as there is space again
+	coalesce
 };
 
-//! ringbuffer out port for plugins to reference a host ringbuffer
+//! ringbuffer out port for plugins to send messages to the host, e.g.
+//! meter values, state changes or UI echoes. All writes are non-blocking
+//! and real time safe. The host reads the ringbuffer with an
+//! osc_ringbuffer_in, see osc_ringbuffer_in::drain().
 class osc_ringbuffer_out : public ringbuffer_out<char>
 {
-	// TODO: untested
 	using base = ringbuffer_out<char>;
+
+	//! a message that did not fit yet, including its header
+	struct pending_msg
+	{
+		char* data;
+		std::size_t size;
+	};
+
+	const std::size_t size;
+	const full_policy_t policy;
+	const std::size_t max_msg, max_pending;
+	//! max_pending + 1 buffers of max_msg bytes
+	char* const pending_buf;
+	//! max_pending messages, followed by one spare buffer
+	pending_msg* const pending;
+	std::size_t npending = 0;
+	std::size_t dropped_msgs = 0;
+
+	//! call @p encode on the free ringbuffer memory, and publish the
+	//! bytes that it used
+	template<class Encode>
+	bool write_encoded(Encode encode)
+	{
+		osc_ringbuffer& rb = ref();
+		const std::size_t used = encode(rb.reserve(rb.write_space()));
+		if(used)
+			rb.commit(used);
+		return used;
+	}
+
+	//! whether the messages (behind their 4 byte headers) have the same
+	//! path and type string
+	static bool same_key(const char* m1, const char* m2)
+	{
+		m1 += 4, m2 += 4;
+		return !std::strcmp(m1, m2) && !std::strcmp(
+			pseudo_rtosc::rtosc_argument_string(m1),
+			pseudo_rtosc::rtosc_argument_string(m2));
+	}
+
+	//! write a message that did not fit into the ringbuffer, according
+	//! to the policy
+	//! @param size returns the size of the message, only for statistics
+	template<class Encode, class Size>
+	bool keep(Encode encode, Size size)
+	{
+		pending_msg& spare = pending[npending];
+		if(policy == full_policy_t::drop || !(spare.size =
+			encode(ring_region(spare.data, max_msg))))
+			return drop(size());
+		std::size_t i = 0;
+		for(; i < npending && !same_key(pending[i].data, spare.data); ++i)
+			;
+		if(i < npending)
+			std::swap(pending[i], spare); // replace the older value
+		else if(npending < max_pending)
+			++npending;
+		else
+			return drop(size());
+		return true;
+	}
+
+	//! count a dropped message of @p size bytes, here and in the
+	//! ringbuffer's statistics
+	bool drop(std::size_t size)
+	{
+		++dropped_msgs;
+		ref().count_drop(1, size);
+		return false;
+	}
+
+	template<class Encode, class Size>
+	bool try_write_encoded(Encode encode, Size size) {
+		return (flush() && write_encoded(encode)) || keep(encode, size); }
 public:
 	SPA_OBJECT
+
 	void set_ref(osc_ringbuffer* pointer) {
 		base::ref = static_cast<ringbuffer<char>*>(pointer); }
 	osc_ringbuffer& ref() {
 		return static_cast<osc_ringbuffer&>(*base::ref); }
 	const osc_ringbuffer& ref() const {
 		return static_cast<const osc_ringbuffer&>(*base::ref); }
+
+	//! connect to the host's ringbuffer @p rb, which should have been
+	//! constructed with get_size()
+	void connect(osc_ringbuffer& rb) { set_ref(&rb); }
+	//! size that the host must use for the ringbuffer
+	std::size_t get_size() const { return size; }
+
+	//! Write a message if there is space, otherwise handle it according
+	//! to the policy. Messages kept by full_policy_t::coalesce are being
+	//! written before any later message.
+	//! @return false iff the message has been dropped
+	bool try_write(const char *dest, const char *args, ...)
+	{
+		va_list va;
+		va_start(va,args);
+		const bool res = try_write(dest, args, va);
+		va_end(va);
+		return res;
+	}
+	bool try_write(const char *dest, const char *args, va_list va)
+	{
+		return try_write_encoded([&](const ring_region& free) {
+			va_list va2;
+			va_copy(va2, va);
+			const std::size_t used =
+				detail::encode(free, 0, dest, args, va2);
+			va_end(va2);
+			return used;
+		},
+			[&]() { return detail::encoded_size(dest, args, va); });
+	}
+
+	//! @see try_write(), osc_ringbuffer::write_typed()
+	template<class ...Args>
+	bool try_write_typed(const char *dest, Args... args)
+	{
+		return try_write_encoded([&](const ring_region& free) {
+			return detail::encode_typed(free, 0, dest, args...); },
+			[&]() { return detail::typed_size(dest, args...); });
+	}
+
+	//! write the messages kept by full_policy_t::coalesce, as far as
+	//! there is space. This never blocks, and messages which still do
+	//! not fit stay kept, without counting as dropped.
+	//! @return true iff no messages are left
+	bool flush()
+	{
+		std::size_t done = 0;
+		for(; done < npending && base::ref->try_write(pending[done].data,
+			pending[done].size); ++done) ;
+		// move the rest to the front, keeping each buffer
+		for(std::size_t i = done; i < npending; ++i)
+			std::swap(pending[i - done], pending[i]);
+		npending -= done;
+		return !npending;
+	}
+
+	//! number of messages that have been dropped
+	std::size_t dropped() const { return dropped_msgs; }
+
+	//! @param size see get_size()
+	//! @param policy what to do if the ringbuffer is full
+	//! @param max_msg maximum size of a message kept for coalescing
+	//! @param max_pending number of messages kept for coalescing
+	osc_ringbuffer_out(std::size_t size,
+		full_policy_t policy = full_policy_t::drop,
+		std::size_t max_msg = 256, std::size_t max_pending = 16) :
+		size(size), policy(policy), max_msg(max_msg),
+		max_pending(max_pending),
+		pending_buf(new char[(max_pending + 1) * max_msg]),
+		pending(new pending_msg[max_pending + 1])
+	{
+		for(std::size_t i = 0; i <= max_pending; ++i)
+			pending[i] = { pending_buf + i * max_msg, 0 };
+	}
+	osc_ringbuffer_out(const osc_ringbuffer_out& ) = delete;
+	~osc_ringbuffer_out() { delete[] pending_buf; delete[] pending; }
+};
+
+/*
+	OSC dispatch
+*/
+
+//! Non-template part of osc_dispatcher: a trie over the path segments of
+//! rtosc style patterns, e.g. "/part#16/volume:f:i" or "/voice#8/".
+//! All edges of the trie live in one hash table, so matching a path costs
+//! one or two lookups per segment, independent of the number of patterns.
+//! Literal segments take precedence over segments with "#N" ranges. If
+//! nothing below the literal segment matches, each matching ranged one is
+//! tried in turn, e.g. "/part0/bar" matches "/part#16/bar" next to
+//! "/part0/foo", and "/a1/y" matches "/a#8/y" next to "/a#2/x". Deeper
+//! matches take precedence over patterns ending with '/'.
+class osc_dispatcher_base
+{
+	//! a trie edge, parent --(segment)--> child
+	struct edge
+	{
+		unsigned parent, child; //!< child 0 means unused
+		std::uint32_t hash;
+		const char* seg;
+		std::size_t seg_len;
+		bool ranged; //!< segment contains a "#N" range
+	};
+
+	//! per pattern: argument restrictors and the next pattern on its node
+	struct pattern_info
+	{
+		const char* args; //!< points to the first ':', or nullptr
+		unsigned next; //!< next index + 1, 0 for none
+	};
+
+	edge* edges = nullptr;
+	std::size_t edge_mask = 0;
+	//! per node, first pattern index + 1, 0 for none
+	unsigned* leaf_patterns = nullptr;
+	unsigned* subtree_patterns = nullptr;
+	pattern_info* patterns = nullptr;
+	unsigned nodes = 0;
+	static constexpr unsigned root = 1;
+
+	static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+	static std::uint32_t hash_step(std::uint32_t h, char c) {
+		return (h ^ (unsigned char)c) * 16777619u; }
+	static constexpr std::uint32_t hash_init = 2166136261u;
+	std::size_t slot(unsigned parent, std::uint32_t hash) const {
+		return (hash ^ (parent * 0x9e3779b9u)) & edge_mask; }
+
+	//! hash of a segment with each digit run and each "#N" replaced by '#'
+	static std::uint32_t ranged_hash(const char* seg, std::size_t len)
+	{
+		std::uint32_t h = hash_init;
+		for(const char* end = seg + len; seg != end; )
+		{
+			if(*seg == '#' || is_digit(*seg))
+			{
+				h = hash_step(h, '#');
+				for(++seg; seg != end && is_digit(*seg); ++seg) ;
+			}
+			else
+				h = hash_step(h, *seg++);
+		}
+		return h;
+	}
+
+	//! match a message path segment against a pattern segment with ranges
+	static bool match_ranged(const char* pat, std::size_t pat_len,
+		const char* seg, std::size_t seg_len)
+	{
+		const char *pat_end = pat + pat_len, *seg_end = seg + seg_len;
+		while(pat != pat_end)
+		{
+			if(*pat == '#')
+			{
+				unsigned max = 0, value = 0, digits = 0;
+				for(++pat; pat != pat_end && is_digit(*pat); ++pat)
+					max = max * 10 + (*pat - '0');
+				for(; seg != seg_end && is_digit(*seg); ++seg)
+					if(++digits < 10)
+						value = value * 10 + (*seg - '0');
+				if(!digits || digits >= 10 || value >= max)
+					return false;
+			}
+			else if(is_digit(*pat))
+			{
+				// literal numbers must match the whole digit run
+				for(; pat != pat_end && is_digit(*pat); ++pat, ++seg)
+					if(seg == seg_end || *seg != *pat)
+						return false;
+				if(seg != seg_end && is_digit(*seg))
+					return false;
+			}
+			else if(seg == seg_end || *pat++ != *seg++)
+				return false;
+		}
+		return seg == seg_end;
+	}
+
+	//! check the argument restrictors, e.g. ":f:ff" or "::i"
+	static bool match_args(const char* args, const char* types)
+	{
+		if(!args)
+			return true;
+		for(; *args == ':'; )
+		{
+			const char* t = types;
+			for(++args; *args && *args != ':' && *args == *t; ++args, ++t) ;
+			if((!*args || *args == ':') && !*t)
+				return true;
+			for(; *args && *args != ':'; ++args) ;
+		}
+		return false;
+	}
+
+	//! @return the child of @p node reached by the literal segment @p seg
+	unsigned find_child(unsigned node, const char* seg,
+		std::size_t len, std::uint32_t hash) const
+	{
+		for(std::size_t i = slot(node, hash); edges[i].child;
+			i = (i + 1) & edge_mask)
+		{
+			const edge& e = edges[i];
+			if(e.parent == node && e.hash == hash && !e.ranged &&
+				e.seg_len == len && !std::memcmp(e.seg, seg, len))
+				return e.child;
+		}
+		return 0;
+	}
+
+	unsigned add_child(unsigned node, const char* seg, std::size_t len)
+	{
+		bool ranged = false;
+		for(std::size_t i = 0; i < len; ++i)
+		{
+			if(seg[i] == '#')
+			{
+				if(i + 1 == len || !is_digit(seg[i + 1]))
+					throw invalid_pattern_error(seg);
+				ranged = true;
+			}
+		}
+		std::uint32_t h = hash_init;
+		if(ranged)
+			h = ranged_hash(seg, len);
+		else
+			for(std::size_t i = 0; i < len; ++i)
+				h = hash_step(h, seg[i]);
+
+		std::size_t i = slot(node, h);
+		for(; edges[i].child; i = (i + 1) & edge_mask)
+		{
+			const edge& e = edges[i];
+			if(e.parent == node && e.hash == h && e.ranged == ranged &&
+				e.seg_len == len && !std::memcmp(e.seg, seg, len))
+				return e.child;
+		}
+		edges[i] = edge { node, nodes++, h, seg, len, ranged };
+		return edges[i].child;
+	}
+
+	static void append(unsigned* first, unsigned idx,
+		pattern_info* patterns)
+	{
+		for(; *first; first = &patterns[*first - 1].next) ;
+		*first = idx + 1;
+	}
+
+	void add_pattern(const char* pat, unsigned idx)
+	{
+		const char* args = std::strchr(pat, ':');
+		const char* end = args ? args : pat + std::strlen(pat);
+		patterns[idx].args = args;
+
+		unsigned node = root;
+		const char* seg = pat + (*pat == '/');
+		for(const char* c = seg; ; ++c)
+		{
+			if(c == end || *c == '/')
+			{
+				if(c != seg || c != end)
+					node = add_child(node, seg, c - seg);
+				if(c == end)
+					break;
+				seg = c + 1;
+				if(seg == end)
+				{
+					append(subtree_patterns + node, idx,
+						patterns);
+					break;
+				}
+			}
+		}
+		if(end == pat || end == pat + 1 || end[-1] != '/')
+			append(leaf_patterns + node, idx, patterns);
+	}
+
+	void clear()
+	{
+		delete[] edges;
+		delete[] leaf_patterns;
+		delete[] subtree_patterns;
+		delete[] patterns;
+		edges = nullptr;
+		leaf_patterns = subtree_patterns = nullptr;
+		patterns = nullptr;
+		edge_mask = 0;
+		nodes = 0;
+	}
+
+protected:
+	//! build the trie from @p n entries, each having a member "pattern"
+	//! the patterns must stay valid as long as this dispatcher is in use
+	//! @throw invalid_pattern_error on a '#' without following digits
+	template<class Entry>
+	void build(const Entry* entries, std::size_t n)
+	{
+		clear();
+		std::size_t max_nodes = root + 1;
+		for(std::size_t i = 0; i < n; ++i)
+			for(const char* c = entries[i].pattern; *c && *c != ':'; ++c)
+				max_nodes += (*c == '/');
+		max_nodes += n;
+		std::size_t capacity = 4;
+		while(capacity < 2 * max_nodes)
+			capacity *= 2;
+
+		edges = new edge[capacity]();
+		edge_mask = capacity - 1;
+		leaf_patterns = new unsigned[max_nodes]();
+		subtree_patterns = new unsigned[max_nodes]();
+		patterns = new pattern_info[n]();
+		nodes = root + 1;
+
+		try {
+			for(std::size_t idx = 0; idx < n; ++idx)
+				add_pattern(entries[idx].pattern, idx);
+		} catch(...) {
+			clear();
+			throw;
+		}
+	}
+
+	//! @return the first pattern in the list @p first (see
+	//!   leaf_patterns) whose argument restrictors match @p types, or -1
+	int first_match(unsigned first, const char* types) const
+	{
+		for(unsigned i = first; i; i = patterns[i - 1].next)
+			if(match_args(patterns[i - 1].args, types))
+				return (int)i - 1;
+		return -1;
+	}
+
+	//! find the first pattern matching the path that starts with segment
+	//! @p seg below @p node; see find()
+	int find_below(unsigned node, const char* seg, const char* types,
+		const char** rest) const
+	{
+		std::uint32_t exact = hash_init, ranged = hash_init;
+		bool has_digits = false;
+		const char* c = seg;
+		for(; *c && *c != '/'; ++c)
+		{
+			exact = hash_step(exact, *c);
+			if(is_digit(*c))
+			{
+				if(!has_digits || !is_digit(c[-1]))
+					ranged = hash_step(ranged, '#');
+				has_digits = true;
+			}
+			else
+				ranged = hash_step(ranged, *c);
+		}
+		const std::size_t len = c - seg;
+		// the literal child first; if nothing below it matches, the
+		// path may still match through any ranged one, e.g. "a1" through
+		// both "a#2" and "a#8", which share their hash
+		int idx;
+		const unsigned child = find_child(node, seg, len, exact);
+		if(child && (idx = match_child(child, c, types, rest)) >= 0)
+			return idx;
+		if(!has_digits)
+			return -1;
+		for(std::size_t i = slot(node, ranged); edges[i].child;
+			i = (i + 1) & edge_mask)
+		{
+			const edge& e = edges[i];
+			if(e.parent == node && e.hash == ranged && e.ranged &&
+				match_ranged(e.seg, e.seg_len, seg, len) &&
+				(idx = match_child(e.child, c, types, rest)) >= 0)
+				return idx;
+		}
+		return -1;
+	}
+
+	//! find the first pattern matching the path below @p child, which
+	//! has been reached by the segment ending at @p c; see find_below()
+	int match_child(unsigned child, const char* c, const char* types,
+		const char** rest) const
+	{
+		int idx;
+		if(!*c)
+			idx = first_match(leaf_patterns[child], types);
+		else if((idx = find_below(child, c + 1, types, rest)) >= 0)
+			return idx; // rest has been set by the deeper match
+		else // a pattern ending with '/' matches the rest
+			idx = first_match(subtree_patterns[child], types);
+		if(idx >= 0)
+			*rest = c;
+		return idx;
+	}
+
+	//! find the first pattern matching @p path and @p types
+	//! @param rest if a pattern ending with '/' matched, the remaining path
+	//!   (starting with '/'), otherwise the end of @p path
+	//! @return index of the pattern, or -1 if none matched
+	int find(const char* path, const char* types, const char** rest) const
+	{
+		if(!nodes)
+			return -1;
+		const char* seg = path + (*path == '/');
+		if(*seg)
+			return find_below(root, seg, types, rest);
+		// only the path "/" ends at the root
+		*rest = seg;
+		return first_match(leaf_patterns[root], types);
+	}
+
+	osc_dispatcher_base() = default;
+	osc_dispatcher_base(const osc_dispatcher_base& ) = delete;
+	~osc_dispatcher_base() { clear(); }
+};
+
+//! Calls handlers for OSC messages whose path matches their pattern
+//! The pattern syntax is the one of pseudo_rtosc::rtosc_match, i.e.
+//! (normal-path)(\#digit-specifier)?(/)?(:argument-restrictor)*
+//! Build the table once in plugin::init(), e.g.
+//! @code
+//!   static const osc_dispatcher<my_plugin>::entry entries[] = {
+//!   	{ "/gain:f", [](my_plugin& p, const osc_msg& m, const char*) {
+//!   		p.gain = m.arg(0).f; } } };
+//!   dispatcher.init(entries);
+//! @endcode
+template<class Self>
+class osc_dispatcher : public osc_dispatcher_base
+{
+public:
+	//! handler for a matched message
+	//! @param rest for patterns ending with '/', the unmatched rest of the
+	//!   path, starting with '/', e.g. for dispatching it further
+	using handler_t = void (*)(Self& self, const osc_msg& msg,
+		const char* rest);
+	struct entry
+	{
+		const char* pattern;
+		handler_t handler;
+	};
+
+	//! build the dispatch table, not realtime safe
+	//! @p entries must stay valid as long as this dispatcher is in use
+	void init(const entry* entries, std::size_t n) {
+		build(entries, n);
+		table = entries;
+	}
+	template<std::size_t N>
+	void init(const entry (&entries)[N]) { init(entries, N); }
+
+	//! call the handler of the first pattern matching @p msg, or, if
+	//! @p msg is a bundle, dispatch each of its elements
+	//! @return whether any pattern matched (for bundles: for each element)
+	bool dispatch(Self& self, const osc_msg& msg) const
+	{
+		if(!msg.is_bundle())
+			return dispatch(self, msg, msg.path());
+		bool all = true;
+		for(const osc_msg& element : msg.elements())
+			all = dispatch(self, element) && all;
+		return all;
+	}
+	//! like dispatch(Self&, const osc_msg&), but match @p path
+	//! instead of the message's path, e.g. the rest of a parent dispatcher
+	bool dispatch(Self& self, const osc_msg& msg, const char* path) const
+	{
+		const char* rest;
+		const int idx = find(path, msg.types(), &rest);
+		if(idx < 0)
+			return false;
+		table[idx].handler(self, msg, rest);
+		return true;
+	}
+
+private:
+	const entry* table = nullptr;
 };
 
 /*
@@ -238,39 +2046,62 @@ public:
 
 class visitor : public virtual spa::visitor
 {
+	family_entry own_entry; //!< see register_family()
+protected:
+	//! @see spa::visitor::visit_as()
+	template<class Base, class Port>
+	void visit_as(Port& p) { visit(static_cast<Base&>(p)); }
 public:
+	//! family id of this interface, see spa::visitor::as()
+	static constexpr uint32_t family = family_id("spa::audio::visitor");
+
 	using spa::visitor::visit;
 
-#define SPA_MK_VISIT_AUDIO(type) \
-	SPA_MK_VISIT(control_in<type>, port_ref<const type>) \
-	SPA_MK_VISIT(control_out<type>, port_ref<type>)
+	// controls, visited as their port_ref by default
+#define SPA_VISIT_CONTROL(type) \
+	virtual void visit(control_in<type>& p) { \
+		visit_as<port_ref<const type>>(p); } \
+	virtual void visit(control_out<type>& p) { \
+		visit_as<port_ref<type>>(p); }
 
-#define SPA_MK_VISIT_AUDIO2(type) \
-	SPA_MK_VISIT_AUDIO(type) \
-	SPA_MK_VISIT_AUDIO(unsigned type)
+	SPA_VISIT_CONTROL(bool)
+	SPA_VISIT_CONTROL(char)
+	SPA_VISIT_CONTROL(unsigned char)
+	SPA_VISIT_CONTROL(short)
+	SPA_VISIT_CONTROL(unsigned short)
+	SPA_VISIT_CONTROL(int)
+	SPA_VISIT_CONTROL(unsigned int)
+	SPA_VISIT_CONTROL(long)
+	SPA_VISIT_CONTROL(unsigned long)
+	SPA_VISIT_CONTROL(long long)
+	SPA_VISIT_CONTROL(unsigned long long)
+	SPA_VISIT_CONTROL(float)
+	SPA_VISIT_CONTROL(double)
 
-	SPA_MK_VISIT_AUDIO(bool)
-	SPA_MK_VISIT_AUDIO2(char)
-	SPA_MK_VISIT_AUDIO2(short)
-	SPA_MK_VISIT_AUDIO2(int)
-	SPA_MK_VISIT_AUDIO2(long)
-	SPA_MK_VISIT_AUDIO2(long long)
-	SPA_MK_VISIT_AUDIO(float)
-	SPA_MK_VISIT_AUDIO(double)
+#undef SPA_VISIT_CONTROL
 
-#undef SPA_MK_VISIT_AUDIO2
-#undef SPA_MK_VISIT_AUDIO
+	virtual void visit(audio::stereo::in& p) {
+		visit_as<port_ref_base>(p); }
+	virtual void visit(audio::stereo::out& p) {
+		visit_as<port_ref_base>(p); }
 
-	SPA_MK_VISIT(audio::stereo::in, port_ref_base)
-	SPA_MK_VISIT(audio::stereo::out, port_ref_base)
+	virtual void visit(osc_ringbuffer_in& p) {
+		visit_as<ringbuffer_in<char>>(p); }
+	virtual void visit(osc_ringbuffer_out& p) {
+		visit_as<ringbuffer_out<char>>(p); }
 
-	SPA_MK_VISIT(osc_ringbuffer_in, ringbuffer_in<char>)
-	SPA_MK_VISIT(osc_ringbuffer_out, ringbuffer_out<char>)
+	virtual void visit(in& p) { visit_as<port_ref<const float>>(p); }
+	virtual void visit(out& p) { visit_as<port_ref<float>>(p); }
+	virtual void visit(samplerate& p) {
+		visit_as<control_in<int>>(p); }
+	virtual void visit(buffersize& p) {
+		visit_as<control_in<int>>(p); }
+	virtual void visit(port_table& p) { visit_as<port_ref_base>(p); }
 
-	SPA_MK_VISIT(in, port_ref<const float>)
-	SPA_MK_VISIT(out, port_ref<float>)
-	SPA_MK_VISIT(samplerate, control_in<int>)
-	SPA_MK_VISIT(buffersize, control_in<int>)
+	visitor() : own_entry() { register_family(this, own_entry); }
+	visitor(const visitor& ) : spa::visitor(), own_entry() {
+		register_family(this, own_entry); }
+	visitor& operator=(const visitor& ) { return *this; }
 };
 
 /*
@@ -291,8 +2122,10 @@ ACCEPT_SPA_AUDIO_T(control_in)
 ACCEPT_SPA_AUDIO_T(control_out)
 ACCEPT_SPA_AUDIO(samplerate)
 ACCEPT_SPA_AUDIO(buffersize)
+ACCEPT_SPA_AUDIO(port_table)
 
 ACCEPT_SPA_AUDIO(osc_ringbuffer_in)
+ACCEPT_SPA_AUDIO(osc_ringbuffer_out)
 
 #undef ACCEPT_SPA_AUDIO_T
 #undef ACCEPT_SPA_AUDIO
@@ -26,6 +26,7 @@ namespace spa {
 namespace audio {
 
 class invalid_args_error;
+class invalid_pattern_error;
 
 namespace stereo {
 	class in;
@@ -40,11 +41,25 @@ template<class T> class control_in;
 template<class T> class control_out;
 class samplerate;
 class buffersize;
+class port_table;
+class ramp_bank;
+
+class osc_msg;
+class osc_msg_range;
+class osc_bundle_range;
+struct sub_block;
+class split_block;
+class osc_msg_template;
 
 class osc_ringbuffer;
+class osc_mpsc_ringbuffer;
+class osc_latest_table;
 class osc_ringbuffer_in;
 class osc_ringbuffer_out;
 
+class osc_dispatcher_base;
+template<class Self> class osc_dispatcher;
+
 class visitor;
 
 }
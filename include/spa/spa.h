@@ -40,7 +40,14 @@
 //       * return types from non-inline functions
 //       * thrown errors that reach plugin and host
 //       must be in your own (version) control, i.e. no STL, boost, libXYZ...
+//       The only exception is std::atomic of integers, as used by the
+//       ringbuffers: they must be lock free and as large as the integer,
+//       so they are plain integers in memory and do not depend on the
+//       standard library's implementation (checked below).
 #include <cstdarg> // only functions for varargs
+#include <cstring> // only functions for memcpy
+#include <atomic>  // only lock free atomic integers, see above
+#include "wait.h"  // platform dependent sleeping of ringbuffer threads
 
 // The same counts for our own libraries!
 #include <ringbuffer/ringbuffer.h>
@@ -74,6 +81,13 @@ public:
 
 namespace detail {
 
+// see the note about shared data above
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2 &&
+	ATOMIC_LLONG_LOCK_FREE == 2, "atomic integers must be lock free");
+static_assert(sizeof(std::atomic<std::size_t>) == sizeof(std::size_t) &&
+	sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+	"atomic integers must be plain integers in memory");
+
 inline unsigned m_strlen(const char* str)
 {
 	unsigned sz = 0;
@@ -127,6 +141,28 @@ public:
 		size(size) {}
 };
 
+//! a port was visited by a visitor which does not implement the port's
+//! visitor interface, e.g. an audio port by a plain spa::visitor
+class visitor_type_error : public error_base
+{
+public:
+	uint32_t family; //!< the visitor interface that was missing
+	visitor_type_error(uint32_t family) :
+		error_base("visitor can not visit this port type"),
+		family(family) {}
+};
+
+//! a visitor implements two interfaces with the same family id, i.e. two
+//! interfaces have the same name, or their names' hashes collide
+class visitor_family_error : public error_base
+{
+public:
+	uint32_t family; //!< the family id that was registered twice
+	visitor_family_error(uint32_t family) :
+		error_base("visitor interfaces with equal family ids"),
+		family(family) {}
+};
+
 //! name of the entry function that a host must resolve
 constexpr const char* descriptor_name = "spa_descriptor";
 
@@ -342,31 +378,460 @@ public:
 	ringbuffer(std::size_t size) : ringbuffer_t<T>(size) {}
 };
 
-//! char ringbuffer specialization, which supports a special write function
+//! One or two contiguous regions of char ringbuffer memory. The second
+//! region is only non-empty if the memory wraps around the buffer's end.
+class ring_region
+{
+public:
+	char* first;
+	std::size_t first_size;
+	char* second;
+	std::size_t second_size;
+
+	//! total number of bytes
+	std::size_t size() const { return first_size + second_size; }
+	//! whether all bytes are in the first region
+	bool contiguous() const { return !second_size; }
+
+	//! byte number @p i of the region
+	char& operator[](std::size_t i) const {
+		return i < first_size ? first[i] : second[i - first_size]; }
+
+	//! return the region without the first @p offset bytes
+	ring_region sub(std::size_t offset) const
+	{
+		return offset < first_size
+			? ring_region(first + offset, first_size - offset,
+				second, second_size)
+			: ring_region(second + (offset - first_size),
+				size() - offset, nullptr, 0);
+	}
+
+	//! copy the first @p n bytes of the region to @p dest
+	void copy_to(char* dest, std::size_t n) const
+	{
+		std::size_t n1 = n < first_size ? n : first_size;
+		std::memcpy(dest, first, n1);
+		if(n > n1)
+			std::memcpy(dest + n1, second, n - n1);
+	}
+
+	//! fill the first @p n bytes of the region from @p src
+	void copy_from(const char* src, std::size_t n) const
+	{
+		std::size_t n1 = n < first_size ? n : first_size;
+		std::memcpy(first, src, n1);
+		if(n > n1)
+			std::memcpy(second, src + n1, n - n1);
+	}
+
+	//! write @p len as 4 byte big endian length field
+	void put_length(uint32_t len) const
+	{
+		const char lenc[4] = { (char)((len >> 24) & 0xFF),
+			(char)((len >> 16) & 0xFF),
+			(char)((len >> 8) & 0xFF),
+			(char)((len) & 0xFF)};
+		copy_from(lenc, 4);
+	}
+
+	//! read a 4 byte big endian length field
+	uint32_t get_length() const
+	{
+		unsigned char lenc[4];
+		copy_to((char*)lenc, 4);
+		return ((uint32_t)lenc[0] << 24) | ((uint32_t)lenc[1] << 16)
+			| ((uint32_t)lenc[2] << 8) | (uint32_t)lenc[3];
+	}
+
+	ring_region(char* first = nullptr, std::size_t first_size = 0,
+		char* second = nullptr, std::size_t second_size = 0) :
+		first(first), first_size(first_size),
+		second(second), second_size(second_size) {}
+};
+
+//! what a char ringbuffer does with a write that does not fit
+//! There is no "drop oldest": only the reader may advance the read
+//! position, and the reader may still be using the oldest messages in
+//! place (see ringbuffer_in<char>::view_msgs()), so the writer can never
+//! overwrite them.
+enum class overflow_policy_t
+{
+	drop_newest, //!< drop the message that is being written
+	//! wait until the reader has made space, up to a timeout, then drop
+	//! the message. Only for writers which are not real time threads.
+	block
+};
+
+//! char ringbuffer specialization, which supports writing messages
+//! in place. Unlike the other ringbuffers, it manages its memory itself,
+//! in order to be able to hand out memory regions. It supports exactly
+//! one reader, which must be a ringbuffer_in<char>.
 template<>
-class ringbuffer<char> : public ringbuffer_base<char>
+class ringbuffer<char>
+{
+	friend class ringbuffer_in<char>;
+
+	static std::size_t round_up_pow2(std::size_t n)
+	{
+		std::size_t res = 1;
+		for(; res < n; res <<= 1) ;
+		return res;
+	}
+protected:
+	const std::size_t size; //!< a power of 2
+	char* const buf;
+	//! total number of bytes ever written, or read
+	std::atomic<std::size_t> w_ptr, r_ptr;
+	//! whether writers wake the reader, see set_wakeup()
+	bool wakeup = false;
+	//! 1 while the reader is sleeping, or about to sleep
+	std::atomic<uint32_t> sleeping;
+
+	overflow_policy_t overflow_policy = overflow_policy_t::drop_newest;
+	unsigned block_timeout_ms = 0;
+	//! statistics, see dropped_messages()
+	std::atomic<std::size_t> dropped_msgs, dropped_size, max_used;
+
+	//! Called when a write did not fit. With overflow_policy_t::block,
+	//! sleep shortly, so that the write can be retried.
+	//! @param waited number of previous calls for the same write
+	//! @return false if the write shall be given up
+	bool wait_for_space(unsigned& waited) const
+	{
+		if(overflow_policy != overflow_policy_t::block ||
+			waited >= block_timeout_ms * 10)
+			return false;
+		++waited;
+		detail::sleep_us(100);
+		return true;
+	}
+
+	//! update the high water mark, after publishing up to counter value
+	//! @p end
+	void track_used(std::size_t end)
+	{
+		const std::size_t used =
+			end - r_ptr.load(std::memory_order_relaxed);
+		std::size_t cur = max_used.load(std::memory_order_relaxed);
+		while(used > cur && !max_used.compare_exchange_weak(cur, used,
+			std::memory_order_relaxed)) ;
+	}
+
+	//! wake the reader if it is sleeping in ringbuffer_in<char>::wait()
+	void wake_reader()
+	{
+		// pairs with the fence in wait(): either the reader sees the new
+		// data, or this sees that the reader sleeps
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(sleeping.load(std::memory_order_relaxed) &&
+			sleeping.exchange(0))
+			detail::wake(sleeping);
+	}
+
+	//! return @p n bytes of memory, beginning at counter value @p pos
+	ring_region region(std::size_t pos, std::size_t n) const
+	{
+		const std::size_t idx = pos & (size - 1);
+		const std::size_t n1 = n < size - idx ? n : size - idx;
+		return ring_region(buf + idx, n1, buf, n - n1);
+	}
+public:
+	//! flag in the length field of a message, telling that the length
+	//! field is followed by the message's 4 byte frame offset
+	static constexpr uint32_t frame_flag = 0x80000000u;
+
+	//! size of the length field, plus the frame offset if it is non-zero
+	static std::size_t header_size(uint32_t frame) {
+		return frame ? 8 : 4; }
+
+	//! write the header for a message of @p len bytes to be processed at
+	//! frame @p frame of the reader's next block
+	static void put_header(const ring_region& r, uint32_t len,
+		uint32_t frame)
+	{
+		if(frame)
+		{
+			r.put_length(len | frame_flag);
+			r.sub(4).put_length(frame);
+		}
+		else
+			r.put_length(len);
+	}
+
+	//! number of bytes that can currently be written
+	std::size_t write_space() const {
+		return size - (w_ptr.load(std::memory_order_relaxed)
+			- r_ptr.load(std::memory_order_acquire)); }
+
+	//! Return @p n bytes of free memory, or an empty region if there is
+	//! not enough space. Nothing is visible to the reader until commit()
+	//! is called. Use reserve(write_space()) if the size is not yet known.
+	ring_region reserve(std::size_t n) const
+	{
+		return (write_space() < n)
+			? ring_region()
+			: region(w_ptr.load(std::memory_order_relaxed), n);
+	}
+
+	//! make the first @p n bytes of the last reserved region visible to
+	//! the reader
+	void commit(std::size_t n)
+	{
+		const std::size_t end = w_ptr.load(std::memory_order_relaxed) + n;
+		w_ptr.store(end, std::memory_order_release);
+		track_used(end);
+		if(wakeup)
+			wake_reader();
+	}
+
+	//! Let writes wake a reader which sleeps in ringbuffer_in<char>::wait()
+	//! because the ringbuffer was empty. This costs a fence per write, and
+	//! a system call only when the reader actually sleeps, so it is meant
+	//! for non real time readers like UI mirrors, loggers or offline
+	//! renderers. Must be set before any thread uses the ringbuffer.
+	void set_wakeup(bool enable) { wakeup = enable; }
+
+	//! write @p len bytes from @p data if there is enough space right
+	//! now. Unlike write(), this never blocks and never counts a drop, so
+	//! writers which keep a message to retry it later can call it
+	//! repeatedly.
+	//! @return whether the bytes have been written
+	bool try_write(const char* data, std::size_t len)
+	{
+		const ring_region r = reserve(len);
+		if(r.size() < len)
+			return false;
+		r.copy_from(data, len);
+		commit(len);
+		return true;
+	}
+
+	//! write @p len bytes from @p data, if there is enough space (see
+	//! set_overflow_policy())
+	//! @return the number of bytes written (0 or @p len)
+	std::size_t write(const char* data, std::size_t len)
+	{
+		unsigned waited = 0;
+		while(!try_write(data, len))
+		{
+			if(!wait_for_space(waited))
+			{
+				count_drop(1, len);
+				return 0;
+			}
+		}
+		return len;
+	}
+
+	//! like try_write(), but write @p len bytes from @p data as one
+	//! message, optionally with a frame offset (see put_header())
+	//! @return whether the message has been written; empty messages
+	//!   are never written
+	bool try_write_with_length(const char* data, std::size_t len,
+		uint32_t frame = 0)
+	{
+		const std::size_t header = header_size(frame);
+		const ring_region r = len ? reserve(len + header) : ring_region();
+		if(!r.size())
+			return false;
+		put_header(r, len, frame);
+		r.sub(header).copy_from(data, len);
+		commit(len + header);
+		return true;
+	}
+
+	//! write @p len bytes from @p data as one message, if there is enough
+	//! space, optionally with a frame offset (see put_header())
+	//! @return false iff the message has been dropped, which includes
+	//!   empty messages
+	bool write_with_length(const char* data, std::size_t len,
+		uint32_t frame = 0)
+	{
+		unsigned waited = 0;
+		while(!try_write_with_length(data, len, frame))
+		{
+			if(!len || !wait_for_space(waited))
+			{
+				count_drop(1, len);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//! choose what happens to writes that do not fit, see
+	//! overflow_policy_t. Must be set before any thread uses the
+	//! ringbuffer.
+	//! @param timeout_ms time to wait for overflow_policy_t::block, counted
+	//!   in sleeps of 0.1 ms, so the real time can be slightly longer
+	void set_overflow_policy(overflow_policy_t policy,
+		unsigned timeout_ms = 0)
+	{
+		overflow_policy = policy;
+		block_timeout_ms = timeout_ms;
+	}
+
+	//! number of messages that did not fit and have been dropped
+	std::size_t dropped_messages() const {
+		return dropped_msgs.load(std::memory_order_relaxed); }
+	//! total size of the messages that have been dropped
+	std::size_t dropped_bytes() const {
+		return dropped_size.load(std::memory_order_relaxed); }
+	//! maximum number of bytes that have ever been unread at once, to
+	//! help choosing the ringbuffer's size
+	std::size_t high_water_mark() const {
+		return max_used.load(std::memory_order_relaxed); }
+
+	//! account for @p msgs messages of @p bytes bytes that were dropped,
+	//! for writers which drop messages themselves. Only call this when a
+	//! message is given up for good, not when a write is going to be
+	//! retried.
+	void count_drop(std::size_t msgs, std::size_t bytes)
+	{
+		dropped_msgs.fetch_add(msgs, std::memory_order_relaxed);
+		dropped_size.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	std::size_t get_size() const { return size; }
+
+	ringbuffer(std::size_t size) :
+		size(round_up_pow2(size)), buf(new char[this->size]),
+		w_ptr(0), r_ptr(0), sleeping(0),
+		dropped_msgs(0), dropped_size(0), max_used(0) {}
+	ringbuffer(const ringbuffer& ) = delete;
+	~ringbuffer() { delete[] buf; }
+};
+
+//! char ringbuffer that can be written by multiple threads at once,
+//! without locks. Writers reserve their space by advancing a shared
+//! reserve counter, and mark their message as complete in a per slot
+//! commit table when they are done. w_ptr is only advanced over complete
+//! messages, in order, by whichever writer finds the next message
+//! complete, so the reader (a ringbuffer_in<char>) is the same as for
+//! ringbuffer<char>. Only whole messages can be written, and their sizes,
+//! including the header, must be multiples of 4 (OSC messages are).
+class mpsc_ringbuffer : public ringbuffer<char>
 {
-	using base = ringbuffer_base<char>;
+	using base = ringbuffer<char>;
+
+	// single writer functions of the base class
+	using base::reserve;
+	using base::commit;
+	using base::write;
+	using base::try_write;
+	using base::try_write_with_length;
+
+	//! total number of bytes ever reserved by writers
+	std::atomic<std::size_t> reserve_ptr;
+	//! for each 4 byte slot, the end counter value of the last message
+	//! that started at this slot and is complete
+	std::atomic<std::size_t>* const done;
+
+	std::atomic<std::size_t>& slot(std::size_t pos) const {
+		return done[(pos >> 2) & ((size >> 2) - 1)]; }
 public:
-	void write_with_length(const char* data, std::size_t len)
+	//! number of bytes that can currently be reserved; unlike
+	//! ringbuffer<char>::write_space(), this excludes regions that other
+	//! writers have reserved, but not yet committed. Another writer may
+	//! still take the space before this one reserves it.
+	std::size_t write_space() const
+	{
+		// r_ptr first: reserve_ptr is never behind any r_ptr seen before
+		const std::size_t r = r_ptr.load(std::memory_order_acquire);
+		return size - (reserve_ptr.load(std::memory_order_relaxed) - r);
+	}
+
+	//! Reserve @p n bytes, concurrently with other writers. On success,
+	//! the writer must fill the whole region and call commit_shared()
+	//! with the same @p pos and @p n, even if it does not need the memory
+	//! anymore (it can write a message that the reader ignores).
+	//! @param pos receives the counter value of the region
+	//! @return the region, or an empty region if there is not enough space
+	ring_region reserve_shared(std::size_t n, std::size_t& pos)
+	{
+		pos = reserve_ptr.load(std::memory_order_relaxed);
+		do {
+			if(pos + n - r_ptr.load(std::memory_order_acquire) > size)
+				return ring_region();
+		} while(!reserve_ptr.compare_exchange_weak(pos, pos + n,
+			std::memory_order_relaxed));
+		return region(pos, n);
+	}
+
+	//! mark the region returned by reserve_shared() as complete, and
+	//! publish all complete messages that are next in order
+	void commit_shared(std::size_t pos, std::size_t n)
+	{
+		// if all previous messages are published, publish this one
+		// directly, otherwise leave it to the writer of the previous one
+		std::size_t w = pos;
+		bool published = w_ptr.compare_exchange_strong(w, pos + n);
+		if(published)
+			w = pos + n;
+		else
+		{
+			slot(pos).store(pos + n);
+			w = w_ptr.load();
+		}
+		// A message starting at w is complete iff its slot holds an end
+		// value > w. Older values of the slot are <= w, and newer ones
+		// can not exist before w has been read. The seq_cst operations
+		// make sure that either this writer sees the messages completed
+		// after its own, or their writers see this one published.
+		for(std::size_t end; (end = slot(w).load()) > w; )
+		{
+			if(w_ptr.compare_exchange_strong(w, end))
+				w = end, published = true;
+		}
+		if(published)
+			track_used(w);
+		if(wakeup)
+			wake_reader();
+	}
+
+	//! Like reserve_shared(), but handle the overflow according to the
+	//! overflow policy if there is not enough space. @p n must not be 0.
+	//! @return the region, or an empty region if the message is dropped
+	ring_region reserve_or_drop(std::size_t n, std::size_t& pos)
 	{
-		if(write_space() >= len + 4)
+		ring_region r;
+		unsigned waited = 0;
+		while(!(r = reserve_shared(n, pos)).size() &&
+			wait_for_space(waited)) ;
+		if(!r.size())
+			count_drop(1, n);
+		return r;
+	}
+
+	//! write @p len bytes from @p data as one message, if there is enough
+	//! space, optionally with a frame offset (see put_header())
+	//! @return false iff the message has been dropped, which includes
+	//!   empty messages
+	bool write_with_length(const char* data, std::size_t len,
+		uint32_t frame = 0)
+	{
+		const std::size_t header = header_size(frame);
+		std::size_t pos;
+		const ring_region r = len ? reserve_or_drop(len + header, pos)
+			: ring_region();
+		if(!r.size())
 		{
-			uint32_t len32 = len;
-			//printf("vmessage length: %u\n", len32);
-
-			char lenc[4] = { (char)((len32 >> 24) & 0xFF),
-				(char)((len32 >> 16) & 0xFF),
-				(char)((len32 >> 8) & 0xFF),
-				(char)((len32) & 0xFF)};
-			//printf("length array: %x %x %x %x\n",
-			//	+lenc[0], +lenc[1], +lenc[2], +lenc[3]);
-			base::write(lenc, 4);
-			base::write(data, len);
+			if(!len)
+				count_drop(1, 0);
+			return false;
 		}
+		put_header(r, len, frame);
+		r.sub(header).copy_from(data, len);
+		commit_shared(pos, len + header);
+		return true;
 	}
 
-	ringbuffer(std::size_t size) : base(size) {}
+	mpsc_ringbuffer(std::size_t size) :
+		base(size), reserve_ptr(0),
+		done(new std::atomic<std::size_t>[get_size() >> 2]()) {}
+	mpsc_ringbuffer(const mpsc_ringbuffer& ) = delete;
+	~mpsc_ringbuffer() { delete[] done; }
 };
 
 /*
@@ -391,46 +856,189 @@ public:
 
 //! ringbuffer in port for plugins to reference a host ringbuffer
 template<>
-class ringbuffer_in<char> : public ringbuffer_in_base<char>
+class ringbuffer_in<char> : public virtual input
 {
+	ringbuffer<char>* ref = nullptr;
+	std::size_t size;
+	//! bytes of the message returned by view_msg(), not yet released
+	std::size_t viewed = 0;
+
+	void release_viewed()
+	{
+		if(viewed)
+			release(viewed), viewed = 0;
+	}
+
+	//! header of a message in the ringbuffer
+	struct msg_header
+	{
+		std::size_t size; //!< size of the header
+		uint32_t length; //!< length of the message
+		uint32_t frame; //!< frame offset, 0 if none was written
+	};
+
+	//! read the header at counter value @p pos, where @p space bytes
+	//! are readable
+	//! @return false if there is no message
+	bool get_header(std::size_t pos, std::size_t space,
+		msg_header& h) const
+	{
+		if(space < 4)
+			return false;
+		const uint32_t field = ref->region(pos, 4).get_length();
+		h.size = ringbuffer<char>::header_size(
+			field & ringbuffer<char>::frame_flag);
+		h.length = field & ~ringbuffer<char>::frame_flag;
+		if(space < h.size || space - h.size < h.length)
+			throw error_base("char ringbuffer contains corrupted data");
+		h.frame = (h.size == 8) ? ref->region(pos + 4, 4).get_length()
+			: 0;
+		return true;
+	}
 public:
 	SPA_OBJECT
-	using base = ringbuffer_in_base<char>;
-	using base::ringbuffer_in_base;
+
+	//! number of bytes that can currently be read
+	std::size_t read_space() const {
+		return ref->w_ptr.load(std::memory_order_acquire)
+			- ref->r_ptr.load(std::memory_order_relaxed); }
+
+	//! return @p n readable bytes, beginning @p offset bytes behind the
+	//! read position, without consuming them
+	ring_region peek(std::size_t offset, std::size_t n) const {
+		return ref->region(ref->r_ptr.load(std::memory_order_relaxed)
+			+ offset, n); }
+
+	//! consume @p n bytes, making them available to the writer again
+	void release(std::size_t n)
+	{
+		ref->r_ptr.store(ref->r_ptr.load(std::memory_order_relaxed) + n,
+			std::memory_order_release);
+	}
+
+	//! Sleep until there is data to read, but at most @p timeout_ms
+	//! milliseconds. The writer must have enabled
+	//! ringbuffer<char>::set_wakeup(), otherwise this always sleeps
+	//! until the timeout if the ringbuffer is empty. Not real time safe.
+	//! @return true iff there is data to read
+	bool wait(unsigned timeout_ms)
+	{
+		if(read_space())
+			return true;
+		ref->sleeping.store(1, std::memory_order_relaxed);
+		// pairs with the fence in ringbuffer<char>::wake_reader()
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(!read_space())
+			detail::wait_on(ref->sleeping, 1, timeout_ms);
+		ref->sleeping.store(0, std::memory_order_relaxed);
+		return read_space();
+	}
 
 	//! read the next message into temporary buffer
+	//! @param frame if non-null, receives the message's frame offset
 	//! @return true iff there was a next message;
-	bool read_msg(char* read_buffer, std::size_t max)
+	bool read_msg(char* read_buffer, std::size_t max,
+		uint32_t* frame = nullptr)
 	{
-		if(read_space() > 0)
+		release_viewed();
+		msg_header h;
+		if(get_header(ref->r_ptr.load(std::memory_order_relaxed),
+			read_space(), h))
 		{
-			uint32_t length;
+			if(max < h.length)
 			{
-				auto rd = read(4);
-				length =  (+rd[3])
-					+ (+rd[2] << 8)
-					+ (+rd[1] << 16)
-					+ (+rd[0] << 24);
-				//printf("read length array: %x%x%x%x\n",
-				//+rd[0], +rd[1], +rd[2], +rd[3]);
+				release(h.size + h.length);
+				throw out_of_range_error(h.length, max);
 			}
+			peek(h.size, h.length).copy_to(read_buffer, h.length);
+			release(h.size + h.length);
+			if(frame)
+				*frame = h.frame;
+			return true;
+		}
+		else
+			return false;
+	}
 
-			//printf("len: %d\n", +length);
-			if(length && read_space() < length)
-				throw error_base("char ringbuffer "
-					"contains corrupted data");
-			if(max < length)
-				throw out_of_range_error(length, max);
+	//! Release the message returned by the last call, and return the
+	//! next message without copying it. Only if the message wraps around
+	//! the buffer's end, it is copied into @p linear_buffer.
+	//! The returned memory stays valid until the next call of
+	//! view_msg() or read_msg().
+	//! @param frame if non-null, receives the message's frame offset
+	//! @param length if non-null, receives the message's length
+	//! @return the message, or nullptr if there was no next message
+	const char* view_msg(char* linear_buffer, std::size_t max,
+		uint32_t* frame = nullptr, uint32_t* length = nullptr)
+	{
+		release_viewed();
+		msg_header h;
+		if(!get_header(ref->r_ptr.load(std::memory_order_relaxed),
+			read_space(), h))
+			return nullptr;
+		viewed = h.size + h.length;
+		if(frame)
+			*frame = h.frame;
+		if(length)
+			*length = h.length;
+
+		const ring_region msg = peek(h.size, h.length);
+		if(msg.contiguous())
+			return msg.first;
+		if(max < h.length)
+			throw out_of_range_error(h.length, max);
+		msg.copy_to(linear_buffer, h.length);
+		return linear_buffer;
+	}
+
+	//! Release all messages returned by the last call, and return all
+	//! complete messages that are currently readable, but at most
+	//! @p max_msgs. The readable space is being read only once, and all
+	//! messages are released at once by the next view_msgs(), view_msg()
+	//! or read_msg() call. At most one message can wrap around the
+	//! buffer's end; it is copied into @p linear_buffer.
+	//! @param msgs array of at least @p max_msgs views, which must be
+	//!   constructible from the message (const char*), its frame
+	//!   offset (uint32_t) and its length (uint32_t)
+	//! @return number of messages stored in @p msgs
+	template<class View>
+	std::size_t view_msgs(View* msgs, std::size_t max_msgs,
+		char* linear_buffer, std::size_t max)
+	{
+		release_viewed();
+		const std::size_t space = read_space();
+		const std::size_t r = ref->r_ptr.load(std::memory_order_relaxed);
+		std::size_t pos = 0, n = 0;
+		msg_header h;
+		for(; n < max_msgs && get_header(r + pos, space - pos, h); ++n)
+		{
+			const ring_region msg = ref->region(r + pos + h.size,
+				h.length);
+			pos += h.size + h.length;
+			if(msg.contiguous())
+				msgs[n] = View(msg.first, h.frame, h.length);
+			else if(max < h.length)
+			{
+				viewed = pos;
+				throw out_of_range_error(h.length, max);
+			}
 			else
 			{
-				auto rd = read(length);
-				rd.copy(read_buffer, length);
+				msg.copy_to(linear_buffer, h.length);
+				msgs[n] = View(linear_buffer, h.frame, h.length);
 			}
-			return true;
 		}
-		else
-			return false;
+		viewed = pos;
+		return n;
 	}
+
+	//! connect to the host's ringbuffer @p rb, which should have been
+	//! constructed with get_size()
+	void connect(ringbuffer<char>& rb) { ref = &rb; }
+	//! size that the host must use for the ringbuffer
+	std::size_t get_size() const { return size; }
+
+	ringbuffer_in(std::size_t size) : size(size) {}
 };
 
 //! ringbuffer out port for plugins to reference a host ringbuffer
@@ -442,56 +1050,261 @@ public:
 	ringbuffer<T>* ref;
 };
 
-//! make a visitor function for type @p type, which will default to
-//! visiting a base class @p base of it
-#define SPA_MK_VISIT(type, base) \
-	virtual void visit(type& p) { visit(static_cast<base&>(p)); }
+//! family id of the visitor interface with the (qualified) name @p name,
+//! e.g. family_id("spa::audio::visitor"). Ids are derived from names, so
+//! that plugins and hosts agree on them without any shared registry.
+constexpr uint32_t family_id(const char* name, uint32_t h = 2166136261u)
+{
+	return *name ? family_id(name + 1, (h ^ (unsigned char)*name) * 16777619u)
+		: h;
+}
 
+//! Base of all visitor interfaces. A port's accept() looks up the
+//! interface that can visit it with as<V>(), and calls the interface's
+//! visit() overload for the port's type. Each overload that a visitor
+//! does not override visits the port as its base port type, and all of
+//! them end in visit(port_ref_base&).
+//! Extensions add visitor interfaces by deriving from this class
+//! (virtually), declaring a static member "family" (see family_id()),
+//! and calling register_family() in their constructors.
 class visitor
 {
 public:
-	virtual void visit(port_ref_base& ) {}
-
-#define SPA_MK_VISIT_PR(type) \
-	SPA_MK_VISIT(port_ref<type>, port_ref_base) \
-	SPA_MK_VISIT(port_ref<const type>, port_ref_base) \
-	SPA_MK_VISIT(ringbuffer_in<type>, port_ref_base)
-
-#define SPA_MK_VISIT_PR2(type) SPA_MK_VISIT_PR(type) \
-	SPA_MK_VISIT_PR(unsigned type)
-
-	SPA_MK_VISIT_PR(bool)
-
-	SPA_MK_VISIT_PR2(char)
-	SPA_MK_VISIT_PR2(short)
-	SPA_MK_VISIT_PR2(int)
-	SPA_MK_VISIT_PR2(long)
-	SPA_MK_VISIT_PR2(long long)
+	//! family id of this interface
+	static constexpr uint32_t family = family_id("spa::visitor");
+protected:
+	//! an interface of a visitor object, as a node of a list which each
+	//! interface keeps inside itself, so the layout of visitor does not
+	//! depend on the number of interfaces
+	struct family_entry
+	{
+		uint32_t id;
+		void* self;
+		family_entry* next;
+	};
+private:
+	//! the visitor interfaces of this object, the most derived first
+	family_entry* families = nullptr;
+	family_entry own_entry; //!< see register_family()
+protected:
+	//! default of the visit() overloads: visit port @p p as its base port
+	//! type @p Base; derived interfaces declare the same for their own
+	//! overloads
+	template<class Base, class Port>
+	void visit_as(Port& p) { visit(static_cast<Base&>(p)); }
+
+	//! make this object's interface @p self available to accept()
+	//! functions, see as()
+	//! @param entry list node, stored in the interface object
+	//! @throw visitor_family_error if another interface of this object
+	//!   has the same family id
+	template<class V>
+	void register_family(V* self, family_entry& entry)
+	{
+		for(const family_entry* e = families; e; e = e->next)
+			if(e->id == V::family)
+				throw visitor_family_error(V::family);
+		entry = family_entry { V::family, self, families };
+		families = &entry;
+	}
+public:
+	//! Return this visitor's interface @p V (e.g. spa::audio::visitor),
+	//! which derives from spa::visitor. This replaces a dynamic_cast by a
+	//! search in a list of usually one or two interfaces, since the ports'
+	//! accept() functions use it for each visit.
+	//! @throw visitor_type_error if this visitor does not implement @p V
+	template<class V>
+	V& as()
+	{
+		for(const family_entry* e = families; e; e = e->next)
+			if(e->id == V::family)
+				return *static_cast<V*>(e->self);
+		throw visitor_type_error(V::family);
+	}
 
-	SPA_MK_VISIT_PR(float)
-	SPA_MK_VISIT_PR(double)
+	virtual void visit(port_ref_base& ) {}
 
-#undef SPA_MK_VISIT_PR2
-#undef SPA_MK_VISIT_PR
+	// typed ports, visited as port_ref_base by default
+#define SPA_VISIT_TYPED(type) \
+	virtual void visit(port_ref<type>& p) { visit_as<port_ref_base>(p); } \
+	virtual void visit(port_ref<const type>& p) { \
+		visit_as<port_ref_base>(p); } \
+	virtual void visit(ringbuffer_in<type>& p) { \
+		visit_as<port_ref_base>(p); } \
+	virtual void visit(ringbuffer_out<type>& p) { \
+		visit_as<port_ref_base>(p); }
+
+	SPA_VISIT_TYPED(bool)
+	SPA_VISIT_TYPED(char)
+	SPA_VISIT_TYPED(unsigned char)
+	SPA_VISIT_TYPED(short)
+	SPA_VISIT_TYPED(unsigned short)
+	SPA_VISIT_TYPED(int)
+	SPA_VISIT_TYPED(unsigned int)
+	SPA_VISIT_TYPED(long)
+	SPA_VISIT_TYPED(unsigned long)
+	SPA_VISIT_TYPED(long long)
+	SPA_VISIT_TYPED(unsigned long long)
+	SPA_VISIT_TYPED(float)
+	SPA_VISIT_TYPED(double)
+
+#undef SPA_VISIT_TYPED
+
+	visitor() : own_entry() { register_family(this, own_entry); }
+	//! copies do not share the source's interfaces
+	visitor(const visitor& ) : visitor() {}
+	visitor& operator=(const visitor& ) { return *this; }
+	virtual ~visitor() {}
 };
 
 //! define an accept function for a (non-template) class
 #define ACCEPT(classname, visitor_type)\
 	inline void classname::accept(class spa::visitor& v) {\
-		dynamic_cast<visitor_type&>(v).visit(*this);\
+		v.as<visitor_type>().visit(*this);\
 	}
 
 //! define an accept function for a template class
 #define ACCEPT_T(classname, visitor_type)\
 	template<class T>\
 	void classname<T>::accept(class spa::visitor& v) {\
-		dynamic_cast<visitor_type&>(v).visit(*this);\
+		v.as<visitor_type>().visit(*this);\
 	}
 
 ACCEPT_T(port_ref, spa::visitor)
 ACCEPT(port_ref_base, spa::visitor)
 ACCEPT_T(ringbuffer_in, spa::visitor)
 ACCEPT(ringbuffer_in<char>, spa::visitor)
+ACCEPT_T(ringbuffer_out, spa::visitor)
+
+//! Triple buffer of n values of type T, publishing consistent snapshots
+//! from one writer thread (e.g. the host) to one reader thread (e.g. the
+//! plugin) without locks. The writer changes the staged values and
+//! publishes all of them at once, e.g. once per block. The reader fetches
+//! the latest published snapshot and then reads it without any atomics.
+//! Neither side ever waits; the reader skips snapshots that were
+//! superseded before it fetched them.
+template<class T>
+class snapshot_block
+{
+	//! flag in middle if the middle slot is newer than the reader's slot
+	static constexpr unsigned fresh = 4;
+	T* slots[3];
+	T* staged;
+	std::size_t n;
+	unsigned back = 0; //!< slot owned by the writer
+	unsigned front = 1; //!< slot owned by the reader
+	std::atomic<unsigned> middle; //!< slot to exchange, maybe | fresh
+
+	static void copy(T* dest, const T* src, std::size_t n) {
+		for(std::size_t i = 0; i < n; ++i) dest[i] = src[i]; }
+public:
+	//! @param n number of values, value-initialized
+	snapshot_block(std::size_t n) :
+		slots{ new T[n](), new T[n](), new T[n]() }, staged(new T[n]()),
+		n(n), middle(2) {}
+	snapshot_block(const snapshot_block& ) = delete;
+	snapshot_block& operator=(const snapshot_block& ) = delete;
+	~snapshot_block()
+	{
+		for(T* slot : slots)
+			delete[] slot;
+		delete[] staged;
+	}
+
+	std::size_t size() const { return n; }
+
+	//! values to be published next (writer side)
+	T* stage() { return staged; }
+	//! make the staged values the latest snapshot (writer side)
+	void publish()
+	{
+		copy(slots[back], staged, n);
+		back = middle.exchange(back | fresh, std::memory_order_acq_rel)
+			& ~fresh;
+	}
+
+	//! take the latest snapshot if it has not been fetched yet (reader
+	//! side), so read() returns it
+	//! @return whether read() changed
+	bool fetch()
+	{
+		if(!(middle.load(std::memory_order_relaxed) & fresh))
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~fresh;
+		return true;
+	}
+	//! the last fetched snapshot (reader side)
+	const T* read() const { return slots[front]; }
+};
+
+//! Hash table from port names to their indices, i.e. their positions in
+//! descriptor::port_names(). It is built once, e.g. as a static object
+//! next to the name list. The hash seed is chosen such that no two names
+//! share a bucket if possible, so a lookup usually costs one hash and one
+//! string compare.
+class port_index_table
+{
+	const char* const* names;
+	unsigned nnames;
+	unsigned mask = 0; //!< number of buckets minus 1
+	uint32_t seed = 0;
+	unsigned* buckets = nullptr; //!< name index + 1, or 0 if empty
+
+	static uint32_t hash(const char* str, uint32_t seed)
+	{
+		uint32_t h = 2166136261u ^ seed;
+		for(; *str; ++str)
+			h = (h ^ (unsigned char)*str) * 16777619u;
+		return h ^ (h >> 15);
+	}
+
+	//! fill the buckets using seed @p s
+	//! @return whether no two names share a bucket
+	bool fill(uint32_t s)
+	{
+		seed = s;
+		bool perfect = true;
+		for(unsigned i = 0; i <= mask; ++i)
+			buckets[i] = 0;
+		for(unsigned i = 0; i < nnames; ++i)
+		{
+			unsigned b = hash(names[i], seed) & mask;
+			for(; buckets[b]; b = (b + 1) & mask)
+				perfect = false;
+			buckets[b] = i + 1;
+		}
+		return perfect;
+	}
+public:
+	//! @return the index of @p name, or -1 if there is no such name
+	int index(const char* name) const
+	{
+		for(unsigned b = hash(name, seed) & mask; buckets[b];
+			b = (b + 1) & mask)
+		{
+			if(detail::m_streq(names[buckets[b] - 1], name))
+				return buckets[b] - 1;
+		}
+		return -1;
+	}
+	//! @return the name with index @p i
+	const char* name(unsigned i) const { return names[i]; }
+	//! number of names
+	unsigned size() const { return nnames; }
+
+	//! @param names array of @p n port names, which must outlive the table
+	port_index_table(const char* const* names, unsigned n) :
+		names(names), nnames(n)
+	{
+		for(mask = 1; mask < 2 * n; mask <<= 1) ;
+		buckets = new unsigned[mask--];
+		// search a collision free seed, otherwise probing resolves them
+		for(uint32_t s = 0; s < 64 && !fill(s); ++s) ;
+	}
+	port_index_table(const port_index_table& ) = delete;
+	port_index_table& operator=(const port_index_table& ) = delete;
+	~port_index_table() { delete[] buckets; }
+};
 
 //! Base class for the spa plugin
 class plugin
@@ -552,6 +1365,20 @@ public:
 	//! Window ID of the main window of the plugin. Must be unique inside
 	//! your window server environment. For X11: Use the X Window ID.
 	virtual const char* window_id() const { return nullptr; }
+
+	// Virtuals added later must come last, so that the vtable slots of
+	// the older ones stay the same for hosts built against old headers.
+
+	//! Return the port with index @p index, i.e. the port named
+	//! descriptor::port_names()[index], without any string lookups.
+	//! Hosts can resolve names once with descriptor::port_index().
+	//! The default throws port_not_found_error, in which case the host
+	//! must use port().
+	virtual port_ref_base& port_at(unsigned index)
+	{
+		(void)index;
+		throw port_not_found_error();
+	}
 };
 
 //! Base class to let the host provide information without
@@ -650,6 +1477,21 @@ public:
 	virtual int version_minor() const { return 0; }
 	virtual int version_patch() const { return 0; }
 
+	// Virtuals added later must come last, see plugin::port_at().
+
+	//! Return the index of the port @p name in port_names(), or -1 if
+	//! there is none, for plugin::port_at(). Indices must not change
+	//! between instances. The default searches port_names(); plugins
+	//! should use a port_index_table.
+	virtual int port_index(const char* name) const
+	{
+		const simple_vec<simple_str> names = port_names();
+		for(unsigned i = 0; i < names.size(); ++i)
+			if(detail::m_streq(names[i].data(), name))
+				return i;
+		return -1;
+	}
+
 	/*
 	 * properties
 	 */
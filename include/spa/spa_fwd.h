@@ -35,12 +35,16 @@ namespace spa
 
 	template<class T> class ringbuffer;
 	template<> class ringbuffer<char>;
+	class mpsc_ringbuffer;
 
 	template<class T> class ringbuffer_in;
 	template<> class ringbuffer_in<char>;
 
 	template<class T> class ringbuffer_out;
 
+	template<class T> class snapshot_block;
+	class port_index_table;
+
 	class visitor;
 
 	class plugin;
@@ -0,0 +1,90 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file wait.h
+	sleeping and waking of ringbuffer threads, the only platform
+	dependent part of spa
+*/
+
+#ifndef SPA_WAIT_H
+#define SPA_WAIT_H
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace spa {
+namespace detail {
+
+//! sleep for about @p us microseconds
+inline void sleep_us(unsigned us)
+{
+#ifdef __linux__
+	struct timespec ts;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000L;
+	nanosleep(&ts, nullptr);
+#else
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+}
+
+//! sleep while @p word has the value @p val, but at most @p timeout_ms
+//! milliseconds. Spurious wakeups are possible.
+inline void wait_on(std::atomic<uint32_t>& word, uint32_t val,
+	unsigned timeout_ms)
+{
+#ifdef __linux__
+	struct timespec ts;
+	ts.tv_sec = timeout_ms / 1000;
+	ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+		FUTEX_WAIT_PRIVATE, val, &ts, nullptr, 0);
+#else
+	// no futex: poll each millisecond
+	for(unsigned i = 0; i < timeout_ms && word.load() == val; ++i)
+		sleep_us(1000);
+#endif
+}
+
+//! wake the thread that is sleeping in wait_on() for @p word
+inline void wake(std::atomic<uint32_t>& word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+		FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+	(void)word;
+#endif
+}
+
+} // namespace detail
+} // namespace spa
+
+#endif // SPA_WAIT_H
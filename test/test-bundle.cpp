@@ -0,0 +1,148 @@
+/*************************************************************************/
+/* test-bundle.cpp - OSC bundle and block splitting tests                */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-bundle.cpp
+	checks iterating bundles in place, and splitting blocks at the frames
+	of OSC events
+*/
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using namespace pseudo_rtosc;
+using spa::audio::osc_msg;
+using spa::audio::osc_msg_range;
+using spa::audio::split_block;
+using spa::audio::sub_block;
+
+static void test_bundles()
+{
+	char a[32], b[32], inner[128], outer[256];
+	rtosc_message(a, sizeof(a), "/a", "i", 1);
+	rtosc_message(b, sizeof(b), "/b", "");
+
+	// an empty bundle has no elements, also if its length is an
+	// upper bound only
+	std::memset(outer, 0, sizeof(outer));
+	const std::size_t empty_len = rtosc_bundle(outer, sizeof(outer), 7, 0);
+	CHECK(empty_len == 16);
+	for(std::size_t len : { empty_len, sizeof(outer) })
+	{
+		rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(outer, len);
+		CHECK(!rtosc_bundle_itr_next(&itr, nullptr));
+	}
+	const osc_msg empty(outer, 0, empty_len);
+	CHECK(empty.is_bundle() && empty.timetag() == 7);
+	unsigned count = 0;
+	for(const osc_msg& m : empty.elements())
+		(void)m, ++count;
+	CHECK(!count);
+
+	// a bundle inside a bundle is one element, walked separately
+	const std::size_t inner_len = rtosc_bundle(inner, sizeof(inner), 1, 2,
+		a, b);
+	CHECK(inner_len == 16 + 4 + 12 + 4 + 8);
+	const std::size_t outer_len = rtosc_bundle(outer, sizeof(outer), 2, 2,
+		inner, a);
+	CHECK(outer_len == 16 + 4 + inner_len + 4 + 12);
+
+	rtosc_bundle_itr_t itr = rtosc_bundle_itr_begin(outer, outer_len);
+	std::size_t size;
+	const char* elm = rtosc_bundle_itr_next(&itr, &size);
+	CHECK(elm == outer + 20 && size == inner_len && rtosc_bundle_p(elm));
+	elm = rtosc_bundle_itr_next(&itr, &size);
+	CHECK(elm && size == 12 && !std::strcmp(elm, "/a"));
+	CHECK(!rtosc_bundle_itr_next(&itr, &size));
+
+	const osc_msg bundle(outer, 3, outer_len);
+	std::vector<std::string> paths;
+	for(const osc_msg& m : bundle.elements())
+	{
+		CHECK(m.frame() == 3);
+		if(m.is_bundle())
+		{
+			CHECK(m.timetag() == 1 && m.size() == inner_len);
+			for(const osc_msg& n : m.elements())
+				paths.push_back(n.path());
+		}
+		else
+			paths.push_back(m.path());
+	}
+	CHECK((paths == std::vector<std::string>{ "/a", "/b", "/a" }));
+
+	// an element longer than the bundle ends the iteration
+	itr = rtosc_bundle_itr_begin(outer, outer_len - 1);
+	CHECK(rtosc_bundle_itr_next(&itr, nullptr));
+	CHECK(!rtosc_bundle_itr_next(&itr, nullptr));
+}
+
+//! split a block of @p nframes frames at events with @p frames
+//! @return start, stop and number of events of each sub-block
+static std::vector<unsigned> split(std::vector<uint32_t> frames,
+	unsigned nframes)
+{
+	static char msg[32];
+	rtosc_message(msg, sizeof(msg), "/x", "");
+	std::vector<osc_msg> msgs;
+	for(uint32_t f : frames)
+		msgs.push_back(osc_msg(msg, f));
+	const osc_msg_range range(msgs.data(), msgs.data() + msgs.size());
+
+	std::vector<unsigned> result;
+	for(const sub_block& b : split_block(range, nframes))
+	{
+		result.push_back(b.start);
+		result.push_back(b.stop);
+		result.push_back(b.events.size());
+	}
+	return result;
+}
+
+static void test_split_block()
+{
+	using v = std::vector<unsigned>;
+	// no events: one sub-block; no frames: no sub-block
+	CHECK(split({}, 16) == (v{ 0, 16, 0 }));
+	CHECK(split({}, 0).empty());
+	CHECK(split({ 3 }, 0).empty());
+	// in order
+	CHECK(split({ 0, 4, 9 }, 16) == (v{ 0, 4, 1, 4, 9, 1, 9, 16, 1 }));
+	CHECK(split({ 4 }, 16) == (v{ 0, 4, 0, 4, 16, 1 }));
+	// equal frames share one sub-block
+	CHECK(split({ 4, 4, 4, 8 }, 16) == (v{ 0, 4, 0, 4, 8, 3, 8, 16, 1 }));
+	// out of order: applied at the previous event's frame
+	CHECK(split({ 8, 2, 12 }, 16) == (v{ 0, 8, 0, 8, 12, 2, 12, 16, 1 }));
+	CHECK(split({ 8, 2, 2 }, 16) == (v{ 0, 8, 0, 8, 16, 3 }));
+	// behind the block: applied at its last frame
+	CHECK(split({ 4, 99 }, 16) == (v{ 0, 4, 0, 4, 15, 1, 15, 16, 1 }));
+	CHECK(split({ 15, 16 }, 16) == (v{ 0, 15, 0, 15, 16, 2 }));
+}
+
+int main()
+{
+	test_bundles();
+	test_split_block();
+	return test::result();
+}
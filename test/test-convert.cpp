@@ -0,0 +1,79 @@
+/*************************************************************************/
+/* test-convert.cpp - OSC byte order conversion tests                    */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-convert.cpp
+	checks rtosc_convert32() and rtosc_convert64() against a byte wise
+	reversal, for lengths covering the SIMD loops and the scalar tails,
+	in place and with unaligned buffers
+*/
+
+#include <cstdint>
+#include <cstring>
+
+#include <rtosc/pseudo-rtosc.h>
+
+#include "test.h"
+
+//! OSC is big endian, so only little endian hosts swap bytes
+static const bool swaps = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+//! check conversions of @p n values of @p width bytes
+static void check_convert(std::size_t width, std::size_t n)
+{
+	// one byte of offset, so that no access is aligned
+	unsigned char src[8 * 20 + 1], dst[8 * 20 + 1], ref[8 * 20];
+	for(std::size_t i = 0; i < width * n; ++i)
+		src[1 + i] = (unsigned char)(i * 7 + 1);
+	for(std::size_t v = 0; v < n; ++v)
+		for(std::size_t b = 0; b < width; ++b)
+			ref[v * width + b] = src[1 + v * width +
+				(swaps ? width - 1 - b : b)];
+	std::memset(dst, 0xee, sizeof(dst));
+
+	void (*convert)(void*, const void*, std::size_t) = (width == 4)
+		? pseudo_rtosc::rtosc_convert32 : pseudo_rtosc::rtosc_convert64;
+	convert(dst + 1, src + 1, n);
+	CHECK(!std::memcmp(dst + 1, ref, width * n));
+	// nothing behind the values has been written
+	CHECK(dst[1 + width * n] == 0xee);
+
+	convert(src + 1, src + 1, n);
+	CHECK(!std::memcmp(src + 1, ref, width * n));
+}
+
+int main()
+{
+	// the widest loop converts 8 values of 32 bit or 4 of 64 bit at once
+	for(std::size_t n = 0; n <= 19; ++n)
+	{
+		check_convert(4, n);
+		check_convert(8, n);
+	}
+
+	// converting twice restores the values
+	const uint32_t v32[5] = { 0x01020304u, 0, 0xffffffffu, 1u, 0x80000000u };
+	uint32_t c32[5];
+	pseudo_rtosc::rtosc_convert32(c32, v32, 5);
+	CHECK(c32[0] == (swaps ? 0x04030201u : 0x01020304u));
+	pseudo_rtosc::rtosc_convert32(c32, c32, 5);
+	CHECK(!std::memcmp(c32, v32, sizeof(v32)));
+
+	return test::result();
+}
@@ -0,0 +1,123 @@
+/*************************************************************************/
+/* test-dispatch.cpp - OSC dispatcher tests                              */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-dispatch.cpp
+	checks which patterns osc_dispatcher matches, especially for paths
+	that only match through a "#N" range next to a literal segment
+*/
+
+#include <cstring>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::osc_msg;
+
+struct receiver
+{
+	int hit = -1;
+	const char* rest = nullptr;
+};
+
+template<int N>
+static void handle(receiver& r, const osc_msg& , const char* rest) {
+	r.hit = N, r.rest = rest; }
+
+static const spa::audio::osc_dispatcher<receiver>::entry entries[] = {
+	{ "/part0/foo", handle<0> },
+	{ "/part#16/bar", handle<1> },
+	{ "/part#16/", handle<2> },
+	{ "/volume:f", handle<3> },
+	{ "/volume:i", handle<4> },
+	{ "/voice#8/note#128/on", handle<5> },
+	{ "/voice1/note60/off", handle<6> },
+	{ "/a#2/x", handle<7> },
+	{ "/a#8/y", handle<8> }
+};
+
+//! dispatch @p path with type string @p types
+//! @return index of the matched pattern, or -1
+static int hit(const char* path, const char* types = "",
+	const char** rest = nullptr)
+{
+	static spa::audio::osc_dispatcher<receiver> dispatcher;
+	static bool initialized = false;
+	if(!initialized)
+		dispatcher.init(entries), initialized = true;
+
+	static char buf[256]; // rest points into it
+	pseudo_rtosc::rtosc_arg_t args[2];
+	args[0].i = args[1].i = 0;
+	pseudo_rtosc::rtosc_amessage(buf, sizeof(buf), path, types, args);
+	receiver r;
+	const bool matched = dispatcher.dispatch(r, osc_msg(buf));
+	CHECK(matched == (r.hit >= 0));
+	if(matched)
+	{
+		// the matched pattern must agree with rtosc_match
+		const char* end;
+		CHECK(pseudo_rtosc::rtosc_match(entries[r.hit].pattern, buf,
+			&end));
+	}
+	if(rest)
+		*rest = r.rest;
+	return r.hit;
+}
+
+int main()
+{
+	// shared prefix: the literal "part0" edge leads to no "bar"
+	CHECK(hit("/part0/foo") == 0);
+	CHECK(hit("/part0/bar") == 1);
+	CHECK(hit("/part3/bar") == 1);
+	CHECK(hit("/part16/bar") == -1);
+
+	// patterns ending with '/' match the rest, deeper matches first
+	const char* rest;
+	CHECK(hit("/part0/baz", "", &rest) == 2);
+	CHECK(!std::strcmp(rest, "/baz"));
+	CHECK(hit("/part5/x/y", "", &rest) == 2);
+	CHECK(!std::strcmp(rest, "/x/y"));
+	CHECK(hit("/part0/bar", "", &rest) == 1 && !*rest);
+
+	// argument restrictors
+	CHECK(hit("/volume", "f") == 3);
+	CHECK(hit("/volume", "i") == 4);
+	CHECK(hit("/volume", "T") == -1);
+
+	// backtracking over several levels
+	CHECK(hit("/voice1/note60/off") == 6);
+	CHECK(hit("/voice1/note60/on") == 5);
+	CHECK(hit("/voice1/note61/on") == 5);
+	CHECK(hit("/voice8/note60/on") == -1);
+
+	// ranged siblings with the same hash: each one is tried
+	CHECK(hit("/a1/x") == 7);
+	CHECK(hit("/a1/y") == 8);
+	CHECK(hit("/a5/y") == 8);
+	CHECK(hit("/a5/x") == -1);
+	CHECK(hit("/a8/y") == -1);
+
+	CHECK(hit("/") == -1);
+	CHECK(hit("/nothing") == -1);
+
+	return test::result();
+}
@@ -0,0 +1,158 @@
+/*************************************************************************/
+/* test-encode.cpp - OSC encoder tests                                   */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-encode.cpp
+	checks that encoding into a split buffer, like the free space of a
+	ringbuffer, or through an osc_msg_template, gives the same bytes as
+	rtosc_amessage
+*/
+
+#include <cstring>
+
+#include <rtosc/pseudo-rtosc.h>
+#include <spa/audio.h>
+
+#include "test.h"
+
+using namespace pseudo_rtosc;
+
+//! encode into two regions, split after @p split bytes, for all splits
+static void check_splits(const char* path, const char* types,
+	const rtosc_arg_t* args)
+{
+	char expected[256];
+	const size_t len = rtosc_amessage(expected, sizeof(expected),
+		path, types, args);
+	CHECK(len > 0);
+	CHECK(len == rtosc_amessage(nullptr, 0, path, types, args));
+
+	for(size_t split = 0; split <= len; ++split)
+	{
+		// the second region is a separate buffer, like the start of
+		// the ring behind its end
+		char first[256], second[256];
+		std::memset(first, 0x55, sizeof(first));
+		std::memset(second, 0x55, sizeof(second));
+		ring_t ring[2] = { { first, split }, { second, len - split } };
+		CHECK(rtosc_amessage_ring(ring, path, types, args) == len);
+
+		char joined[512];
+		std::memcpy(joined, first, split);
+		std::memcpy(joined + split, second, len - split);
+		CHECK(!std::memcmp(joined, expected, len));
+		// nothing may be written behind either region
+		CHECK(first[split] == 0x55 && second[len - split] == 0x55);
+
+		// one byte less does not fit, wherever it is missing
+		ring_t small[2] = { { first, split },
+			{ second, len - split - 1 } };
+		if(split < len)
+			CHECK(!rtosc_amessage_ring(small, path, types, args));
+	}
+}
+
+//! @return whether @p t holds the same message as rtosc_amessage
+static bool same_message(const spa::audio::osc_msg_template& t,
+	const char* path, const char* types, const rtosc_arg_t* args)
+{
+	char expected[256];
+	const size_t len = rtosc_amessage(expected, sizeof(expected),
+		path, types, args);
+	return t.size() == len + 4 &&
+		spa::ring_region(const_cast<char*>(t.data()), 4).get_length()
+			== len &&
+		!std::memcmp(t.data() + 4, expected, len);
+}
+
+static void check_template()
+{
+	using spa::audio::osc_msg_template;
+
+	rtosc_arg_t args[4] = {};
+	osc_msg_template t("/template", "ifThd");
+	CHECK(same_message(t, "/template", "ifThd", args));
+
+	args[0].i = -7;
+	args[1].f = 0.5f;
+	// rtosc_amessage takes no value for T, the template counts it
+	args[2].h = 0x0102030405060708ll;
+	args[3].d = -0.25;
+	t.set<int32_t>(0, -7);
+	t.set(1, 0.5f);
+	t.set<int64_t>(3, 0x0102030405060708ll);
+	t.set(4, -0.25);
+	CHECK(same_message(t, "/template", "ifThd", args));
+
+	// out of range, or the wrong type
+	auto throws_range = [&](unsigned i) {
+		try { t.set<int32_t>(i, 1); }
+		catch(const spa::out_of_range_error& e) {
+			return e.accessed == (int)i && e.size == 5; }
+		return false;
+	};
+	CHECK(throws_range(5));
+	CHECK(throws_range(1000));
+	auto throws_type = [&](unsigned i, float f) {
+		try { t.set(i, f); }
+		catch(const spa::audio::invalid_args_error& e) {
+			return !std::strcmp(e.portname, "/template") &&
+				!std::strcmp(e.args_found, "ifThd"); }
+		return false;
+	};
+	CHECK(throws_type(0, 1.0f));
+	CHECK(throws_type(2, 1.0f));
+	CHECK(throws_type(4, 1.0f));
+	// nothing has been written by the refused calls
+	CHECK(same_message(t, "/template", "ifThd", args));
+
+	osc_msg_template empty("/empty", "");
+	CHECK(same_message(empty, "/empty", "", nullptr));
+	try { empty.set(0, 1.0f); CHECK(false); }
+	catch(const spa::out_of_range_error& ) {}
+
+	// only fixed size arguments
+	try { osc_msg_template s("/s", "is"); CHECK(false); }
+	catch(const spa::audio::invalid_args_error& ) {}
+}
+
+int main()
+{
+	const unsigned char blob_data[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+	rtosc_arg_t f[1], iii[3], sb[2], hd[2];
+	f[0].f = 0.5f;
+	iii[0].i = 0; iii[1].i = 69; iii[2].i = -100;
+	sb[0].s = "some-string-argument";
+	sb[1].b.len = sizeof(blob_data);
+	sb[1].b.data = (uint8_t*)blob_data;
+	hd[0].h = 0x0102030405060708ll;
+	hd[1].d = 0.25;
+
+	check_splits("/part0/Pvolume", "f", f);
+	check_splits("/noteOn", "iii", iii);
+	check_splits("/load-object", "sb", sb);
+	check_splits("/abc", "hd", hd);
+	check_splits("/no-args", "", nullptr);
+	check_splits("/flags", "TFNI", nullptr);
+
+	check_template();
+
+	return test::result();
+}
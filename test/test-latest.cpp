@@ -0,0 +1,130 @@
+/*************************************************************************/
+/* test-latest.cpp - latest value table tests                            */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-latest.cpp
+	checks that osc_latest_table never returns a torn or an older value
+	while one thread writes and another one reads
+*/
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::osc_latest_table;
+using spa::audio::osc_msg;
+
+static const char* const paths[] = {
+	"/p0", "/p1", "/p2", "/p3", "/p4", "/p5", "/p6", "/p7" };
+constexpr int nparams = sizeof(paths) / sizeof(paths[0]);
+
+//! a string argument derived from @p i, of varying length
+static void make_string(char* s, int32_t i)
+{
+	const int len = i % 24;
+	std::memset(s, 'a' + i % 26, len);
+	s[len] = 0;
+}
+
+int main()
+{
+	// only the latest value per key, and only once
+	{
+		osc_latest_table t(4);
+		CHECK(t.write_typed("/a", 1.0f));
+		CHECK(t.write_typed("/a", 2.0f));
+		CHECK(t.write_typed("/a", 3));
+		CHECK(t.write_typed("/b", 4.0f));
+		int n = 0;
+		for(const osc_msg& m : t.read())
+		{
+			++n;
+			if(!std::strcmp(m.path(), "/a") && !std::strcmp(m.types(), "f"))
+				CHECK(m.arg(0).f == 2.0f);
+			else if(!std::strcmp(m.path(), "/a"))
+				CHECK(m.arg(0).i == 3);
+			else
+				CHECK(m.arg(0).f == 4.0f);
+		}
+		CHECK(n == 3);
+		CHECK(!t.read().size());
+		// full, or too large
+		CHECK(t.write_typed("/c", 5));
+		CHECK(!t.write_typed("/d", 6));
+		char large[80] = {};
+		std::memset(large, 'x', sizeof(large) - 1);
+		CHECK(!t.write_typed("/a", (const char*)large));
+	}
+
+	// concurrent writer and reader
+	const int32_t writes = 4 << 20;
+	osc_latest_table t(nparams);
+	std::atomic<bool> done(false);
+	std::thread writer([&]() {
+		char s[32];
+		for(int32_t i = 1; i <= writes; ++i)
+		{
+			make_string(s, i);
+			if(!t.write_typed(paths[i % nparams], i, ~i, (const char*)s))
+				break;
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	int32_t last[nparams] = {};
+	long torn = 0, older = 0, unknown = 0, reads = 0;
+	auto check_msg = [&](const osc_msg& m) {
+		char s[32];
+		const int32_t i = m.arg(0).i;
+		make_string(s, i);
+		int p = 0;
+		for(; p < nparams && std::strcmp(m.path(), paths[p]); ++p) ;
+		if(p == nparams || std::strcmp(m.types(), "iis") ||
+			i % nparams != p)
+			++unknown;
+		else if(m.arg(1).i != ~i || std::strcmp(m.arg(2).s, s))
+			++torn;
+		else if(i <= last[p])
+			++older;
+		else
+			last[p] = i;
+		++reads;
+	};
+	while(!done.load(std::memory_order_acquire))
+		for(const osc_msg& m : t.read())
+			check_msg(m);
+	writer.join();
+	for(const osc_msg& m : t.read())
+		check_msg(m);
+
+	CHECK(!unknown);
+	CHECK(!torn);
+	CHECK(!older);
+	CHECK(reads > 0);
+	// the final value of each parameter has arrived
+	for(int p = 0; p < nparams; ++p)
+		CHECK(last[p] == writes - (writes - p) % nparams);
+	CHECK(!t.read().size());
+
+	return test::result();
+}
@@ -0,0 +1,231 @@
+/*************************************************************************/
+/* test-length.cpp - OSC message length tests                            */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-length.cpp
+	compares rtosc_message_length() and rtosc_message_ring_length() with
+	the former byte wise parser, for random valid and corrupted messages,
+	split at every position of a ring
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <rtosc/pseudo-rtosc.h>
+
+#include "test.h"
+
+using namespace pseudo_rtosc;
+
+namespace reference {
+
+// the parser before the contiguous fast path, which read each byte
+// through deref()
+
+static int has_reserved(char type)
+{
+	switch(type)
+	{
+		case 'i': case 's': case 'b': case 'f':
+		case 'h': case 't': case 'd': case 'S':
+		case 'r': case 'm': case 'c':
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static unsigned char deref(unsigned pos, ring_t *ring)
+{
+	return pos<ring[0].len ? ring[0].data[pos] :
+		((pos-ring[0].len)<ring[1].len ? ring[1].data[pos-ring[0].len]
+		: 0x00);
+}
+
+static size_t bundle_ring_length(ring_t *ring)
+{
+	unsigned pos = 8+8;
+	uint32_t advance = 0;
+	do {
+		advance = deref(pos+0, ring) << (8*3) |
+			deref(pos+1, ring) << (8*2) |
+			deref(pos+2, ring) << (8*1) |
+			deref(pos+3, ring) << (8*0);
+		if(advance)
+			pos += 4+advance;
+	} while(advance);
+
+	return pos <= (ring[0].len+ring[1].len) ? pos : 0;
+}
+
+static size_t ring_length(ring_t *ring)
+{
+	if(deref(0,ring) == '#' && deref(1,ring) == 'b' &&
+		deref(2,ring) == 'u' && deref(3,ring) == 'n' &&
+		deref(4,ring) == 'd' && deref(5,ring) == 'l' &&
+		deref(6,ring) == 'e' && deref(7,ring) == '\0')
+		return bundle_ring_length(ring);
+
+	unsigned pos = 0;
+	while(deref(pos++,ring));
+	pos--;
+
+	for(int i=0; i<4; ++i)
+		if(deref(++pos, ring))
+			break;
+
+	if(deref(pos, ring) != ',')
+		return 0;
+
+	unsigned aligned_pos = pos;
+	int arguments = pos+1;
+	while(deref(++pos,ring));
+	pos += 4-(pos-aligned_pos)%4;
+
+	unsigned toparse = 0;
+	{
+		int arg = arguments-1;
+		while(deref(++arg,ring))
+			toparse += has_reserved(deref(arg,ring));
+	}
+
+	while(toparse)
+	{
+		char arg = deref(arguments++,ring);
+		uint32_t i;
+		switch(arg) {
+			case 'h': case 't': case 'd':
+				pos += 8;
+				--toparse;
+				break;
+			case 'm': case 'r': case 'c': case 'f': case 'i':
+				pos += 4;
+				--toparse;
+				break;
+			case 'S': case 's':
+				while(deref(++pos,ring));
+				pos += 4-(pos-aligned_pos)%4;
+				--toparse;
+				break;
+			case 'b':
+				i = 0;
+				i |= (deref(pos++,ring) << 24);
+				i |= (deref(pos++,ring) << 16);
+				i |= (deref(pos++,ring) << 8);
+				i |= (deref(pos++,ring));
+				pos += i;
+				if((pos-aligned_pos)%4)
+					pos += 4-(pos-aligned_pos)%4;
+				--toparse;
+				break;
+			default:
+				;
+		}
+	}
+
+	return pos <= (ring[0].len+ring[1].len) ? pos : 0;
+}
+
+} // namespace reference
+
+static std::mt19937 rng(42);
+
+static unsigned rand_below(unsigned n) { return rng() % n; }
+
+//! write a random message into @p buf
+//! @return its length
+static std::size_t random_message(char* buf, std::size_t len)
+{
+	static const char type_chars[] = "ifsbhtdScrmTFNI[]";
+	std::string path = "/";
+	for(unsigned i = rand_below(12); i; --i)
+		path += (char)('a' + rand_below(26));
+	std::string types;
+	for(unsigned i = rand_below(6); i; --i)
+		types += type_chars[rand_below(sizeof(type_chars) - 1)];
+
+	static std::string strings[6];
+	static char blob_data[6][16];
+	rtosc_arg_t args[6];
+	unsigned nargs = 0;
+	for(char t : types)
+	{
+		if(!reference::has_reserved(t))
+			continue;
+		rtosc_arg_t& a = args[nargs];
+		a.h = (int64_t)rng() << 32 | rng();
+		if(t == 's' || t == 'S')
+		{
+			strings[nargs].assign(rand_below(10), 'x');
+			a.s = strings[nargs].c_str();
+		}
+		else if(t == 'b')
+		{
+			a.b.len = rand_below(16);
+			a.b.data = (uint8_t*)blob_data[nargs];
+		}
+		++nargs;
+	}
+	return rtosc_amessage(buf, len, path.c_str(), types.c_str(), args);
+}
+
+//! compare the lengths of the @p len bytes in @p msg, contiguous and
+//! split at each position
+static void compare(const char* msg, std::size_t len)
+{
+	{
+		ring_t ref[2] = { { (char*)msg, len }, { nullptr, 0 } };
+		CHECK(rtosc_message_length(msg, len) ==
+			reference::ring_length(ref));
+	}
+
+	char first[512], second[512];
+	for(std::size_t split = 0; split <= len; ++split)
+	{
+		// separate buffers, so that reads behind a part are detected
+		std::memcpy(first, msg, split);
+		std::memcpy(second, msg + split, len - split);
+		ring_t ring[2] = { { first, split }, { second, len - split } };
+		ring_t ref[2] = { ring[0], ring[1] };
+		CHECK(rtosc_message_ring_length(ring) ==
+			reference::ring_length(ref));
+	}
+}
+
+int main()
+{
+	char buf[512];
+	for(unsigned round = 0; round < 2000; ++round)
+	{
+		std::memset(buf, 0, sizeof(buf));
+		const std::size_t len = random_message(buf, sizeof(buf));
+		CHECK(len > 0);
+		compare(buf, len);
+		// truncated
+		compare(buf, rand_below(len));
+		// corrupted: a few random bytes anywhere, including NULs and
+		// the type string
+		for(unsigned i = 1 + rand_below(3); i; --i)
+			buf[rand_below(len)] = (char)rng();
+		compare(buf, len);
+	}
+	return test::result();
+}
@@ -0,0 +1,102 @@
+/*************************************************************************/
+/* test-mpsc.cpp - multi producer ringbuffer tests                       */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-mpsc.cpp
+	checks that osc_mpsc_ringbuffer delivers every message of concurrent
+	writers exactly once and in each writer's order
+*/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::osc_msg;
+using spa::audio::osc_mpsc_ringbuffer;
+using spa::audio::osc_ringbuffer_in;
+
+int main()
+{
+	// uncommitted reservations take space
+	{
+		spa::mpsc_ringbuffer rb(64);
+		std::size_t pos1, pos2;
+		CHECK(rb.reserve_shared(16, pos1).size() == 16);
+		CHECK(rb.write_space() == 48);
+		CHECK(rb.reserve_shared(32, pos2).size() == 32);
+		CHECK(rb.write_space() == 16);
+		CHECK(!rb.reserve_shared(20, pos2).size());
+		rb.commit_shared(pos1 + 16, 32);
+		rb.commit_shared(pos1, 16);
+		CHECK(rb.write_space() == 16);
+	}
+
+	// a small ringbuffer, so that writers often find it full
+	const int writers = 4, per_writer = 50000;
+	osc_mpsc_ringbuffer rb(256);
+	osc_ringbuffer_in in(256);
+	in.connect(rb);
+
+	std::vector<std::thread> threads;
+	for(int w = 0; w < writers; ++w)
+		threads.emplace_back([&rb, w]() {
+			for(int32_t i = 0; i < per_writer; )
+			{
+				if(rb.write_typed("/w", (int32_t)w, i))
+					++i;
+				else
+					std::this_thread::yield();
+			}
+		});
+
+	int32_t next[writers] = {};
+	long read = 0, wrong = 0;
+	const long total = (long)writers * per_writer;
+	const auto timeout = std::chrono::steady_clock::now() +
+		std::chrono::seconds(60);
+	while(read < total && std::chrono::steady_clock::now() < timeout)
+	{
+		const spa::audio::osc_msg_range r = in.read_all();
+		for(const osc_msg& m : r)
+		{
+			const int32_t w = m.arg(0).i;
+			if(w < 0 || w >= writers || m.arg(1).i != next[w]++)
+				++wrong;
+		}
+		read += r.size();
+		if(!r.size())
+			std::this_thread::yield();
+	}
+	for(std::thread& t : threads)
+		t.join();
+
+	CHECK(read == total);
+	CHECK(!wrong);
+	for(int32_t n : next)
+		CHECK(n == per_writer);
+	// nothing more than what has been written
+	CHECK(!in.read_all().size());
+	CHECK(rb.write_space() == rb.get_size());
+
+	return test::result();
+}
@@ -0,0 +1,90 @@
+/*************************************************************************/
+/* test-osc-msg.cpp - OSC message view tests                             */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-osc-msg.cpp
+	checks argument access of osc_msg, inside and behind its offset table
+*/
+
+#include <cstring>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::osc_msg;
+
+int main()
+{
+	char buf[256];
+	// more arguments than the offset table holds
+	const std::size_t len = pseudo_rtosc::rtosc_message(buf, sizeof(buf),
+		"/ten", "iiiiiiiiii", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9);
+	CHECK(len > 0);
+	const osc_msg ten(buf);
+	CHECK(ten.narguments() == 10);
+	for(unsigned i = 0; i < 10; ++i)
+		CHECK(ten.arg(i).i == (int32_t)i);
+
+	pseudo_rtosc::rtosc_message(buf, sizeof(buf), "/two", "fi", 0.5f, 7);
+	const osc_msg two(buf);
+	CHECK(two.narguments() == 2);
+	CHECK(two.arg(0).f == 0.5f && two.arg(1).i == 7);
+	// behind the last argument, but inside the offset table
+	for(unsigned i : { 2u, 7u, 8u, 100u })
+	{
+		bool thrown = false;
+		try {
+			two.arg(i);
+		} catch(spa::out_of_range_error& e) {
+			thrown = (e.accessed == (int)i) && (e.size == 2);
+		}
+		CHECK(thrown);
+	}
+
+	// float runs, starting inside and behind the offset table
+	pseudo_rtosc::rtosc_message(buf, sizeof(buf), "/f", "ffffffffffif",
+		0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10, 11.f);
+	const osc_msg floats(buf);
+	float dest[12];
+	CHECK(floats.arg_floats(0, dest, 12) == 10);
+	for(unsigned i = 0; i < 10; ++i)
+		CHECK(dest[i] == (float)i);
+	CHECK(floats.arg_floats(2, dest, 3) == 3 && dest[0] == 2.f);
+	CHECK(floats.arg_floats(9, dest, 12) == 1 && dest[0] == 9.f);
+	CHECK(floats.arg_floats(10, dest, 12) == 0);
+	CHECK(floats.arg_floats(11, dest, 12) == 1 && dest[0] == 11.f);
+	CHECK(floats.arg_floats(12, dest, 12) == 0);
+	CHECK(floats.arg_floats(100, dest, 12) == 0);
+
+	// no arguments: nothing may be read behind the type string
+	{
+		const std::size_t n = pseudo_rtosc::rtosc_message(buf,
+			sizeof(buf), "/none", "");
+		char* exact = new char[n];
+		std::memcpy(exact, buf, n);
+		const osc_msg none(exact);
+		CHECK(none.arg_floats(0, dest, 12) == 0);
+		CHECK(none.arg_floats(9, dest, 12) == 0);
+		CHECK(!pseudo_rtosc::rtosc_argument_floats(exact, 9, dest, 12));
+		delete[] exact;
+	}
+
+	return test::result();
+}
@@ -0,0 +1,140 @@
+/*************************************************************************/
+/* test-pattern.cpp - compiled OSC pattern tests                         */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-pattern.cpp
+	checks that patterns compiled with rtosc_pattern_compile() match the
+	same messages as rtosc_match() does with the pattern strings, and that
+	compiling fails for invalid patterns and too small buffers
+*/
+
+#include <cstring>
+#include <string>
+
+#include <rtosc/pseudo-rtosc.h>
+
+#include "test.h"
+
+using namespace pseudo_rtosc;
+
+static const char* const patterns[] = {
+	"/volume", "/volume:f", "/volume:f:i", "/volume::i", "/part#16/",
+	"/part#16/volume:f", "/voice#8/note#128/on", "/a#2/x", "/a#8/y",
+	"/", "/part0/", "/x#1",
+	// this matcher is not OSC compliant: brackets, braces and '*' are
+	// literal characters, but compiled and interpreted patterns agree
+	"/[0-9]", "/{a,b}", "/*", "/p*#4"
+};
+
+static const char* const paths[] = {
+	"/volume", "/volume/x", "/volum", "/part0/volume", "/part15/volume",
+	"/part16/volume", "/part007/x", "/part1", "/voice7/note127/on",
+	"/voice1/note128/on", "/a1/x", "/a1/y", "/a5/y", "/", "/part0/",
+	"/x0", "/x1", "/[0-9]", "/5", "/{a,b}", "/a", "/*", "/p*3", "/p*4",
+	"/part99999999999/x"
+};
+
+static const char* const types[] = { "", "f", "i", "fi", "ff" };
+
+//! check that the compiled @p pattern agrees with the pattern string
+static void check_pattern(const char* pattern)
+{
+	char compiled[256];
+	const std::size_t size = rtosc_pattern_compile(pattern, compiled,
+		sizeof(compiled));
+	CHECK(size > 0 && size <= 3 * std::strlen(pattern) + 2);
+
+	// every smaller buffer is too small
+	for(std::size_t len = 0; len < size; ++len)
+	{
+		char small[256];
+		std::memset(small, 0x55, sizeof(small));
+		CHECK(!rtosc_pattern_compile(pattern, small, len));
+		// nothing is written behind the buffer
+		CHECK(small[len] == 0x55);
+	}
+
+	for(const char* path : paths)
+	for(const char* t : types)
+	{
+		char msg[256];
+		rtosc_arg_t args[2];
+		args[0].i = args[1].i = 0;
+		CHECK(rtosc_amessage(msg, sizeof(msg), path, t, args));
+
+		const char *end1 = nullptr, *end2 = nullptr;
+		const bool m1 = rtosc_match(pattern, msg, &end1),
+			m2 = rtosc_pattern_match(compiled, msg, &end2);
+		CHECK(m1 == m2);
+		if(m1 && m2)
+			CHECK(end1 == end2);
+
+		end1 = end2 = nullptr;
+		const bool p1 = rtosc_match_path(pattern, msg, &end1),
+			p2 = rtosc_pattern_match_path(compiled, msg, &end2);
+		CHECK(p1 == p2);
+		if(p1 && p2)
+			CHECK(end1 == end2);
+	}
+}
+
+int main()
+{
+	for(const char* pattern : patterns)
+		check_pattern(pattern);
+
+	// some results, to make sure that both do not just agree
+	char compiled[64], msg[64];
+	CHECK(rtosc_pattern_compile("/part#16/volume:f", compiled, 64));
+	rtosc_message(msg, 64, "/part15/volume", "f", 0.5f);
+	CHECK(rtosc_pattern_match(compiled, msg, nullptr));
+	rtosc_message(msg, 64, "/part16/volume", "f", 0.5f);
+	CHECK(!rtosc_pattern_match(compiled, msg, nullptr));
+	rtosc_message(msg, 64, "/part15/volume", "i", 1);
+	CHECK(!rtosc_pattern_match(compiled, msg, nullptr));
+	CHECK(rtosc_pattern_match_path(compiled, msg, nullptr));
+
+	const char* end;
+	CHECK(rtosc_pattern_compile("/part#16/", compiled, 64));
+	rtosc_message(msg, 64, "/part3/x/y", "");
+	CHECK(rtosc_pattern_match(compiled, msg, &end));
+	CHECK(!std::strcmp(end, "/x/y"));
+
+	CHECK(rtosc_pattern_compile("/{a,b}", compiled, 64));
+	rtosc_message(msg, 64, "/a", "");
+	CHECK(!rtosc_pattern_match(compiled, msg, nullptr));
+
+	// invalid patterns: '#' without digits, ranges above 32 bit
+	CHECK(!rtosc_pattern_compile("/part#/x", compiled, 64));
+	CHECK(!rtosc_pattern_compile("/part#x", compiled, 64));
+	CHECK(!rtosc_pattern_compile("/p#99999999999", compiled, 64));
+
+	// literals longer than 255 chars are split
+	const std::string long_path = "/" + std::string(600, 'x');
+	char big[1024];
+	CHECK(rtosc_pattern_compile(long_path.c_str(), big, sizeof(big)));
+	char long_msg[1024];
+	CHECK(rtosc_message(long_msg, sizeof(long_msg), long_path.c_str(), ""));
+	CHECK(rtosc_pattern_match(big, long_msg, nullptr));
+	CHECK(rtosc_match(long_path.c_str(), long_msg, nullptr));
+	long_msg[300] = 'y';
+	CHECK(!rtosc_pattern_match(big, long_msg, nullptr));
+
+	return test::result();
+}
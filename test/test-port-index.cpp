@@ -0,0 +1,75 @@
+/*************************************************************************/
+/* test-port-index.cpp - port index table tests                          */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-port-index.cpp
+	checks lookups in port_index_table, for name lists where the seed
+	search finds a collision free seed, and for ones where it can not
+	and probing resolves the collisions
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <spa/spa.h>
+
+#include "test.h"
+
+//! check that all @p n names are found at their index, and that similar
+//! names are not found
+static void check_table(const char* const* names, unsigned n)
+{
+	const spa::port_index_table table(names, n);
+	CHECK(table.size() == n);
+	for(unsigned i = 0; i < n; ++i)
+	{
+		CHECK(table.index(names[i]) == (int)i);
+		CHECK(table.name(i) == names[i]);
+		const std::string longer = std::string(names[i]) + "x";
+		CHECK(table.index(longer.c_str()) == -1);
+	}
+	CHECK(table.index("") == -1);
+	CHECK(table.index("not a port") == -1);
+}
+
+int main()
+{
+	// few names: one hash and one compare per lookup
+	const char* const few[] = { "in", "out", "buffersize", "osc", "meter",
+		"ports" };
+	check_table(few, sizeof(few) / sizeof(*few));
+	check_table(few, 1);
+	check_table(few, 0);
+
+	// with 2000 names in 4096 buckets, no seed is collision free
+	std::vector<std::string> strings;
+	for(unsigned i = 0; i < 2000; ++i)
+	{
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "/part%u/volume", i);
+		strings.push_back(buf);
+	}
+	std::vector<const char*> many;
+	for(const std::string& s : strings)
+		many.push_back(s.c_str());
+	check_table(many.data(), many.size());
+
+	return test::result();
+}
@@ -0,0 +1,111 @@
+/*************************************************************************/
+/* test-ramp.cpp - ramp_bank tests                                       */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-ramp.cpp
+	checks the linear and exponential ramps of ramp_bank, the linear
+	fallback of exponential ramps crossing 0, and ramping in chunks
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::ramp_bank;
+using spa::audio::scale_type_t;
+
+static const unsigned frames = 37; // not a multiple of the lanes
+
+static bool near(float x, float y) {
+	return std::fabs(x - y) <= 1e-5f * std::fmax(1.0f, std::fabs(y)); }
+
+//! check that chunks of @p chunk samples give the same ramp as @p whole
+static void check_chunks(const ramp_bank& bank, unsigned i,
+	const float* whole, unsigned chunk)
+{
+	float part[frames];
+	for(unsigned first = 0; first < frames; first += chunk)
+	{
+		bank.ramp(i, part, first, chunk);
+		const unsigned n = std::min(chunk, frames - first);
+		for(unsigned k = 0; k < n; ++k)
+			CHECK(near(part[k], whole[first + k]));
+	}
+}
+
+int main()
+{
+	ramp_bank bank(4);
+	bank.set_scale(1, scale_type_t::logartihmic);
+	bank.set_scale(2, scale_type_t::logartihmic);
+	bank.reset(0, 1.0f);
+	bank.reset(1, 0.5f);
+	bank.reset(2, -1.0f);
+	bank.reset(3, 3.0f);
+	bank.set_target(0, 2.0f);  // linear
+	bank.set_target(1, 8.0f);  // exponential
+	bank.set_target(2, 1.0f);  // exponential, but crossing 0
+	// control 3 stays
+	bank.begin_block(frames);
+	CHECK(bank.changing_count() == 3);
+
+	float out[frames];
+
+	// linear: equal increments, ending at the target
+	bank.ramp(0, out);
+	CHECK(!bank.multiplicative(0));
+	for(unsigned k = 0; k < frames; ++k)
+		CHECK(near(out[k], 1.0f + (k + 1.0f) / frames));
+	CHECK(out[frames - 1] == 2.0f);
+	for(unsigned chunk : { 1u, 5u, 8u, 16u, frames, 100u })
+		check_chunks(bank, 0, out, chunk);
+
+	// exponential: equal factors, ending at the target
+	bank.ramp(1, out);
+	CHECK(bank.multiplicative(1));
+	for(unsigned k = 0; k < frames; ++k)
+		CHECK(near(out[k], 0.5f * std::pow(16.0f, (k + 1.0f) / frames)));
+	CHECK(out[frames - 1] == 8.0f);
+	for(unsigned chunk : { 1u, 5u, 8u, 16u, frames })
+		check_chunks(bank, 1, out, chunk);
+
+	// crossing 0, the exponential ramp falls back to a linear one
+	bank.ramp(2, out);
+	CHECK(!bank.multiplicative(2));
+	for(unsigned k = 0; k < frames; ++k)
+		CHECK(near(out[k], -1.0f + 2.0f * (k + 1.0f) / frames));
+	CHECK(out[frames - 1] == 1.0f);
+
+	// unchanged controls are constant
+	bank.ramp(3, out, 30, 20);
+	for(unsigned k = 0; k < frames - 30; ++k)
+		CHECK(out[k] == 3.0f);
+	CHECK(!bank.is_changing(3) && bank.coefficient(3) == 0.0f);
+
+	// the next block starts at the targets
+	bank.end_block();
+	CHECK(bank.value(1) == 8.0f && !bank.is_changing(1));
+	bank.begin_block(frames);
+	CHECK(!bank.changing_count());
+
+	return test::result();
+}
@@ -0,0 +1,117 @@
+/*************************************************************************/
+/* test-snapshot.cpp - snapshot block tests                              */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-snapshot.cpp
+	checks that snapshot_block only hands out complete snapshots, each
+	newer than the previous one, while one thread publishes and another
+	one fetches
+*/
+
+#include <atomic>
+#include <thread>
+
+#include <spa/spa.h>
+
+#include "test.h"
+
+constexpr std::size_t nvalues = 64;
+
+//! value @p j of snapshot number @p k
+static long long value(long long k, std::size_t j) {
+	return k * 1000003 + (long long)j; }
+
+//! @return the snapshot number of @p v, or -1 if @p v is inconsistent
+static long long snapshot_number(const long long* v)
+{
+	const long long k = v[0] / 1000003;
+	for(std::size_t j = 0; j < nvalues; ++j)
+		if(v[j] != value(k, j))
+			return -1;
+	return k;
+}
+
+int main()
+{
+	// single threaded
+	{
+		spa::snapshot_block<int> b(3);
+		CHECK(b.size() == 3);
+		CHECK(!b.fetch());
+		CHECK(b.read()[0] == 0 && b.read()[2] == 0);
+		b.stage()[0] = 1;
+		b.stage()[2] = 3;
+		// nothing visible before publish()
+		CHECK(!b.fetch());
+		b.publish();
+		CHECK(b.fetch());
+		CHECK(b.read()[0] == 1 && b.read()[1] == 0 && b.read()[2] == 3);
+		CHECK(!b.fetch());
+		// the staged values are kept, only the last publish() counts
+		b.stage()[1] = 2;
+		b.publish();
+		b.stage()[1] = 5;
+		b.publish();
+		CHECK(b.read()[1] == 0);
+		CHECK(b.fetch());
+		CHECK(b.read()[0] == 1 && b.read()[1] == 5 && b.read()[2] == 3);
+		CHECK(!b.fetch());
+	}
+
+	// concurrent writer and reader
+	const long long publishes = 200000;
+	spa::snapshot_block<long long> b(nvalues);
+	std::atomic<bool> done(false);
+	std::thread writer([&]() {
+		for(long long k = 1; k <= publishes; ++k)
+		{
+			long long* v = b.stage();
+			for(std::size_t j = 0; j < nvalues; ++j)
+				v[j] = value(k, j);
+			b.publish();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	long long last = 0, fetched = 0, inconsistent = 0, older = 0;
+	auto check_fetch = [&]() {
+		if(!b.fetch())
+			return;
+		const long long k = snapshot_number(b.read());
+		if(k < 0)
+			++inconsistent;
+		else if(k <= last)
+			++older;
+		else
+			last = k;
+		++fetched;
+	};
+	while(!done.load(std::memory_order_acquire))
+		check_fetch();
+	writer.join();
+	check_fetch();
+
+	CHECK(!inconsistent);
+	CHECK(!older);
+	CHECK(fetched > 0);
+	CHECK(last == publishes);
+	CHECK(!b.fetch());
+
+	return test::result();
+}
@@ -0,0 +1,162 @@
+/*************************************************************************/
+/* test-stats.cpp - ringbuffer overflow statistics tests                 */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-stats.cpp
+	checks that the ringbuffer statistics count each dropped message once,
+	and only when it is given up, and that the high water mark only
+	follows published data
+*/
+
+#include <chrono>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::ringbuffer;
+using spa::overflow_policy_t;
+using spa::audio::osc_ringbuffer;
+using spa::audio::osc_ringbuffer_in;
+using spa::audio::osc_ringbuffer_out;
+using spa::audio::full_policy_t;
+
+static const std::size_t size = 64;
+
+int main()
+{
+	char data[size] = {};
+
+	// raw writes
+	{
+		ringbuffer<char> rb(size);
+		CHECK(rb.write(data, 48) == 48);
+		CHECK(rb.high_water_mark() == 48);
+		// a failed try_write is not a drop
+		CHECK(!rb.try_write(data, 32));
+		CHECK(rb.dropped_messages() == 0);
+		CHECK(rb.dropped_bytes() == 0);
+		CHECK(!rb.write(data, 32));
+		CHECK(!rb.write(data, 20));
+		CHECK(rb.dropped_messages() == 2);
+		CHECK(rb.dropped_bytes() == 52);
+		CHECK(rb.high_water_mark() == 48);
+		CHECK(rb.try_write(data, 16));
+		CHECK(rb.high_water_mark() == 64);
+		CHECK(rb.dropped_messages() == 2);
+	}
+
+	// messages with length field: the bytes count without the header
+	{
+		ringbuffer<char> rb(size);
+		CHECK(rb.write_with_length(data, 40));
+		CHECK(rb.high_water_mark() == 44);
+		CHECK(!rb.try_write_with_length(data, 20));
+		CHECK(rb.dropped_messages() == 0);
+		CHECK(!rb.write_with_length(data, 20, 1));
+		CHECK(!rb.write_with_length(data, 0));
+		CHECK(rb.dropped_messages() == 2);
+		CHECK(rb.dropped_bytes() == 20);
+		CHECK(rb.high_water_mark() == 44);
+	}
+
+	// blocking: the retries are not counted, only the final drop
+	{
+		ringbuffer<char> rb(size);
+		rb.set_overflow_policy(overflow_policy_t::block, 2);
+		CHECK(rb.write(data, 60) == 60);
+		const auto start = std::chrono::steady_clock::now();
+		CHECK(!rb.write(data, 8));
+		CHECK(std::chrono::steady_clock::now() - start >=
+			std::chrono::milliseconds(2));
+		CHECK(rb.dropped_messages() == 1);
+		CHECK(rb.dropped_bytes() == 8);
+		CHECK(!rb.write_with_length(data, 8));
+		CHECK(rb.dropped_messages() == 2);
+		CHECK(rb.dropped_bytes() == 16);
+		CHECK(rb.high_water_mark() == 60);
+	}
+
+	// OSC messages: reading lowers the fill level, not the high water mark
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		// "/x\0\0,i\0\0" plus one int and the 4 byte header: 16 bytes
+		for(int32_t i = 0; i < 4; ++i)
+			CHECK(rb.write_typed("/x", i));
+		CHECK(rb.high_water_mark() == 64);
+		CHECK(!rb.write_typed("/x", (int32_t)4));
+		CHECK(!rb.write("/x", "i", 5));
+		CHECK(rb.dropped_messages() == 2);
+		CHECK(rb.dropped_bytes() == 24);
+		CHECK(in.read_all().size() == 4);
+		in.read_all(); // releases the messages read before
+		CHECK(rb.write_typed("/x", (int32_t)6));
+		CHECK(rb.high_water_mark() == 64);
+		CHECK(rb.dropped_messages() == 2);
+	}
+
+	// plugin out port, dropping: each message counts once, with its size
+	{
+		osc_ringbuffer_out out(size);
+		osc_ringbuffer rb(out.get_size());
+		out.connect(rb);
+		for(int32_t i = 0; i < 4; ++i)
+			CHECK(out.try_write_typed("/x", i));
+		CHECK(!out.try_write_typed("/x", (int32_t)4));
+		CHECK(!out.try_write("/x", "i", 5));
+		CHECK(out.dropped() == 2);
+		CHECK(rb.dropped_messages() == 2);
+		CHECK(rb.dropped_bytes() == 24);
+	}
+
+	// plugin out port, coalescing into a blocking ringbuffer: flushing
+	// neither blocks nor counts, only discarding a message counts
+	{
+		osc_ringbuffer_out out(size, full_policy_t::coalesce, 32, 1);
+		osc_ringbuffer rb(out.get_size());
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		rb.set_overflow_policy(overflow_policy_t::block, 1000);
+		out.connect(rb);
+		for(int32_t i = 0; i < 4; ++i)
+			CHECK(out.try_write_typed("/x", i));
+		const auto start = std::chrono::steady_clock::now();
+		CHECK(out.try_write_typed("/y", (int32_t)4)); // kept
+		CHECK(out.try_write_typed("/y", (int32_t)5)); // replaces it
+		CHECK(!out.flush());
+		CHECK(!out.try_write_typed("/z", (int32_t)6)); // table full
+		CHECK(std::chrono::steady_clock::now() - start <
+			std::chrono::milliseconds(500));
+		CHECK(out.dropped() == 1);
+		CHECK(rb.dropped_messages() == 1);
+		CHECK(rb.dropped_bytes() == 12);
+		CHECK(in.read_all().size() == 4);
+		in.read_all();
+		CHECK(out.flush());
+		const spa::audio::osc_msg_range r = in.read_all();
+		CHECK(r.size() == 1);
+		for(const spa::audio::osc_msg& m : r)
+			CHECK(m.arg(0).i == 5);
+		CHECK(rb.dropped_messages() == 1);
+	}
+
+	return test::result();
+}
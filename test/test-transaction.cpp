@@ -0,0 +1,160 @@
+/*************************************************************************/
+/* test-transaction.cpp - OSC ringbuffer transaction tests               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-transaction.cpp
+	checks commit and rollback of osc_ringbuffer transactions and bundles,
+	also if their messages wrap around the ringbuffer's end
+*/
+
+#include <cstring>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+using spa::audio::osc_msg;
+using spa::audio::osc_ringbuffer;
+using spa::audio::osc_ringbuffer_in;
+
+static const std::size_t size = 256;
+
+//! write and read messages in a new ringbuffer until the write position
+//! is @p pos bytes behind the start of the ringbuffer's memory
+static void move_to(osc_ringbuffer& rb, osc_ringbuffer_in& in,
+	std::size_t pos)
+{
+	// "/x\0\0,i\0\0" plus one int and the 4 byte header: 16 bytes
+	for(std::size_t written = 0; written < pos; written += 16)
+	{
+		rb.write_typed("/x", (int32_t)0);
+		in.read_all();
+	}
+	in.read_all();
+	CHECK(rb.write_space() == size);
+}
+
+//! @return whether @p m is "/n" with the int argument @p i
+static bool is_n(const osc_msg& m, int32_t i)
+{
+	return !std::strcmp(m.path(), "/n") && !std::strcmp(m.types(), "i") &&
+		m.arg(0).i == i;
+}
+
+int main()
+{
+	// commit publishes all messages at once
+	for(std::size_t pos : { 0, 16, 224, 240 })
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		move_to(rb, in, pos);
+		{
+			osc_ringbuffer::transaction t(rb);
+			for(int32_t i = 0; i < 4; ++i)
+				t.write_typed("/n", i);
+			// nothing visible before the commit
+			CHECK(!in.read_all().size());
+			CHECK(t.commit());
+		}
+		const spa::audio::osc_msg_range r = in.read_all();
+		CHECK(r.size() == 4);
+		int32_t i = 0;
+		for(const osc_msg& m : r)
+			CHECK(is_n(m, i++));
+	}
+
+	// rollback publishes nothing and drops nothing
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		move_to(rb, in, 240);
+		const std::size_t space = rb.write_space();
+		{
+			osc_ringbuffer::transaction t(rb);
+			t.write_typed("/n", 1);
+			t.rollback();
+			CHECK(!t.commit());
+		}
+		CHECK(!in.read_all().size());
+		CHECK(rb.write_space() == space);
+		CHECK(!rb.dropped_messages());
+		rb.write_typed("/n", 2);
+		const spa::audio::osc_msg_range r = in.read_all();
+		CHECK(r.size() == 1 && is_n(*r.begin(), 2));
+	}
+
+	// a message that does not fit discards the whole transaction
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		{
+			osc_ringbuffer::transaction t(rb);
+			for(int32_t i = 0; i < 20; ++i)
+				t.write_typed("/n", i);
+			CHECK(!t.commit());
+		}
+		CHECK(!in.read_all().size());
+		CHECK(rb.dropped_messages() == 20);
+	}
+
+	// bundles, wrapping around anywhere
+	for(std::size_t pos = 0; pos < size; pos += 16)
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		move_to(rb, in, pos);
+		{
+			osc_ringbuffer::bundle b(rb, 1, 5);
+			for(int32_t i = 0; i < 3; ++i)
+				b.write_typed("/n", i);
+			CHECK(b.commit());
+		}
+		const spa::audio::osc_msg_range r = in.read_all();
+		CHECK(r.size() == 1);
+		if(r.size() != 1)
+			continue;
+		const osc_msg& bundle = *r.begin();
+		CHECK(bundle.is_bundle() && bundle.timetag() == 1 &&
+			bundle.frame() == 5);
+		int32_t i = 0;
+		for(const osc_msg& m : bundle.elements())
+			CHECK(is_n(m, i++) && m.frame() == 5);
+		CHECK(i == 3);
+	}
+
+	// a rolled back bundle publishes nothing
+	{
+		osc_ringbuffer rb(size);
+		osc_ringbuffer_in in(size);
+		in.connect(rb);
+		{
+			osc_ringbuffer::bundle b(rb, 1);
+			b.write_typed("/n", 1);
+			b.rollback();
+		}
+		CHECK(!in.read_all().size());
+	}
+
+	return test::result();
+}
@@ -0,0 +1,160 @@
+/*************************************************************************/
+/* test-validate.cpp - OSC packet validation tests                       */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-validate.cpp
+	checks that the packet validator accepts well formed messages and
+	bundles and rejects malformed ones
+*/
+
+#include <cstring>
+#include <initializer_list>
+
+#include <rtosc/pseudo-rtosc.h>
+
+#include "test.h"
+
+using namespace pseudo_rtosc;
+
+//! copy of a packet that can be damaged
+struct packet
+{
+	char data[512];
+	std::size_t len;
+	bool valid() const { return rtosc_valid_packet_p(data, len); }
+};
+
+//! wrap @p inner into @p depth bundles
+static packet nest(const packet& inner, unsigned depth)
+{
+	packet p = inner;
+	for(unsigned i = 0; i < depth; ++i)
+	{
+		packet outer;
+		outer.len = rtosc_bundle(outer.data, sizeof(outer.data), i, 1,
+			p.data);
+		p = outer;
+	}
+	return p;
+}
+
+int main()
+{
+	packet msg;
+	const unsigned char blob[5] = { 1, 2, 3, 4, 5 };
+	rtosc_arg_t args[3];
+	args[0].s = "str";
+	args[1].b.len = sizeof(blob);
+	args[1].b.data = (uint8_t*)blob;
+	args[2].i = 42;
+	msg.len = rtosc_amessage(msg.data, sizeof(msg.data), "/path", "sbi",
+		args);
+	// "/path\0\0\0" ",sbi\0\0\0\0" "str\0" [5] 1 2 3 4 5 \0\0\0 [42]
+	CHECK(msg.len == 8 + 8 + 4 + 4 + 8 + 4);
+	CHECK(msg.valid() && rtosc_valid_message_p(msg.data, msg.len));
+
+	// truncated: anywhere inside the message, including strings
+	for(std::size_t len = 0; len < msg.len; ++len)
+	{
+		CHECK(!rtosc_valid_message_p(msg.data, len));
+		CHECK(!rtosc_valid_packet_p(msg.data, len));
+	}
+	// a string without its NUL
+	packet bad = msg;
+	std::memset(bad.data + 16, 'x', 4);
+	CHECK(!bad.valid());
+	// trailing bytes behind the message
+	bad = msg;
+	bad.len += 4;
+	std::memset(bad.data + msg.len, 0, 4);
+	CHECK(!bad.valid());
+
+	// bad padding: behind the path, the type string, a string, a blob
+	for(std::size_t pos : { 6, 7, 13, 15, 19, 29, 31 })
+	{
+		bad = msg;
+		CHECK(!bad.data[pos]);
+		bad.data[pos] = 1;
+		CHECK(!bad.valid());
+	}
+	// unprintable path, unknown type
+	bad = msg;
+	bad.data[2] = '\n';
+	CHECK(!bad.valid());
+	bad = msg;
+	bad.data[10] = 'Q';
+	CHECK(!bad.valid());
+	// blob longer than the message
+	bad = msg;
+	bad.data[23] = 100;
+	CHECK(!bad.valid());
+
+	// bundles
+	packet bundle;
+	bundle.len = rtosc_bundle(bundle.data, sizeof(bundle.data), 1, 2,
+		msg.data, msg.data);
+	CHECK(bundle.valid());
+	CHECK(!rtosc_valid_message_p(bundle.data, bundle.len));
+	for(std::size_t len = 0; len < bundle.len; ++len)
+	{
+		std::memcpy(bad.data, bundle.data, bundle.len);
+		bad.len = len;
+		// cut behind an element, it is a bundle with less elements
+		const bool complete = len >= 16 && !((len - 16) % (4 + msg.len));
+		CHECK(bad.valid() == complete);
+	}
+	// an element longer than the bundle
+	bad = bundle;
+	bad.data[16 + 3] += 4;
+	CHECK(!bad.valid());
+	bad.data[16 + 3] -= 8;
+	CHECK(!bad.valid());
+	// a damaged element
+	bad = bundle;
+	bad.data[20 + msg.len + 4 + 6] = 1;
+	CHECK(!bad.valid());
+
+	// nested bundles, up to a depth of 8
+	CHECK(nest(msg, 1).valid());
+	CHECK(nest(msg, 8).valid());
+	CHECK(!nest(msg, 9).valid());
+	// a damaged message deep inside
+	bad = nest(msg, 3);
+	CHECK(bad.valid());
+	bad.data[3 * 20 + 7] = 1;
+	CHECK(!bad.valid());
+	// an empty bundle nested in a bundle
+	packet empty;
+	empty.len = rtosc_bundle(empty.data, sizeof(empty.data), 0, 0);
+	CHECK(empty.valid() && nest(empty, 2).valid());
+
+	// many packets at once
+	const packet* all[] = { &msg, &bad, &bundle, &empty, &msg };
+	const char* packets[5];
+	std::size_t lens[5];
+	bool valid[5];
+	for(int i = 0; i < 5; ++i)
+		packets[i] = all[i]->data, lens[i] = all[i]->len;
+	lens[4] = msg.len - 1;
+	CHECK(rtosc_valid_packets(packets, lens, 5, valid) == 3);
+	CHECK(valid[0] && !valid[1] && valid[2] && valid[3] && !valid[4]);
+	CHECK(!rtosc_valid_packets(packets, lens, 0, valid));
+
+	return test::result();
+}
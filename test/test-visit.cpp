@@ -0,0 +1,157 @@
+/*************************************************************************/
+/* test-visit.cpp - visitor dispatch tests                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-visit.cpp
+	checks that accept() finds the visitor interface of each port, and
+	that visits which a visitor does not override reach the overload of
+	the port's base port type
+*/
+
+#include <initializer_list>
+
+#include <spa/audio.h>
+
+#include "test.h"
+
+namespace audio = spa::audio;
+
+//! counts which overload has been called
+struct counting_visitor : public virtual audio::visitor
+{
+	int buffersize = 0, const_int = 0, const_float = 0, rb_in = 0,
+		other = 0;
+
+	using audio::visitor::visit;
+	void visit(audio::buffersize& ) override { ++buffersize; }
+	void visit(spa::port_ref<const int>& ) override { ++const_int; }
+	void visit(spa::port_ref<const float>& ) override { ++const_float; }
+	void visit(spa::ringbuffer_in<char>& ) override { ++rb_in; }
+	void visit(spa::port_ref_base& ) override { ++other; }
+};
+
+//! a port of an extension, with its own visitor interface
+struct ext_port : public spa::port_ref_base
+{
+	int directions() const override { return input; }
+	void accept(spa::visitor& v) override;
+};
+
+//! visitor interface of the extension, added without touching spa
+struct ext_visitor : public virtual spa::visitor
+{
+	static constexpr uint32_t family = spa::family_id("test::ext_visitor");
+	family_entry entry;
+	int ext = 0;
+
+	using spa::visitor::visit;
+	virtual void visit(ext_port& ) { ++ext; }
+	ext_visitor() : entry() { register_family(this, entry); }
+};
+
+void ext_port::accept(spa::visitor& v) { v.as<ext_visitor>().visit(*this); }
+
+//! a host visitor implementing both audio and extension ports
+struct both_visitor : public counting_visitor, public ext_visitor
+{
+	using counting_visitor::visit;
+	using ext_visitor::visit;
+};
+
+//! registers the extension interface twice
+struct twice_visitor : public ext_visitor
+{
+	family_entry again;
+	twice_visitor() : again() { register_family(
+		static_cast<ext_visitor*>(this), again); }
+};
+
+int main()
+{
+	audio::buffersize bs;
+	audio::samplerate sr;
+	audio::control_in<int> ci;
+	audio::control_in<float> cf;
+	audio::in in;
+	audio::stereo::out so;
+	audio::control_out<double> cd;
+	audio::osc_ringbuffer_in oi(64);
+
+	{
+		counting_visitor v;
+		for(spa::port_ref_base* p : std::initializer_list<
+			spa::port_ref_base*>{ &bs, &sr, &ci, &cf, &in, &so, &cd, &oi })
+			p->accept(v);
+		CHECK(v.buffersize == 1);
+		CHECK(v.const_int == 2); // samplerate, control_in<int>
+		CHECK(v.const_float == 2); // control_in<float>, in
+		CHECK(v.rb_in == 1);
+		CHECK(v.other == 2); // stereo::out, control_out<double>
+
+		// a copy registers its own interfaces
+		counting_visitor copy(v);
+		static_cast<spa::port_ref_base&>(sr).accept(copy);
+		CHECK(copy.const_int == 3);
+		CHECK(v.const_int == 2);
+	}
+
+	// a plain spa::visitor can not visit audio ports
+	{
+		spa::visitor v;
+		bool thrown = false;
+		try {
+			static_cast<spa::port_ref_base&>(bs).accept(v);
+		} catch(const spa::visitor_type_error& e) {
+			thrown = (e.family == audio::visitor::family);
+		}
+		CHECK(thrown);
+	}
+
+	// an extension family next to the audio family
+	{
+		both_visitor v;
+		ext_port ep;
+		static_cast<spa::port_ref_base&>(ep).accept(v);
+		static_cast<spa::port_ref_base&>(bs).accept(v);
+		CHECK(v.ext == 1 && v.buffersize == 1);
+
+		counting_visitor audio_only;
+		bool thrown = false;
+		try {
+			static_cast<spa::port_ref_base&>(ep).accept(audio_only);
+		} catch(const spa::visitor_type_error& e) {
+			thrown = (e.family == ext_visitor::family);
+		}
+		CHECK(thrown);
+	}
+
+	// family ids must be unique per visitor
+	{
+		bool thrown = false;
+		try {
+			twice_visitor v;
+		} catch(const spa::visitor_family_error& e) {
+			thrown = (e.family == ext_visitor::family);
+		}
+		CHECK(thrown);
+		CHECK(spa::visitor::family != audio::visitor::family);
+	}
+
+	return test::result();
+}
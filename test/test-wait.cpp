@@ -0,0 +1,162 @@
+/*************************************************************************/
+/* test-wait.cpp - ringbuffer wakeup tests                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test-wait.cpp
+	checks that a reader sleeping in ringbuffer_in<char>::wait() is woken
+	by single and multiple writers, and that it times out without wakeups
+*/
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <spa/spa.h>
+
+#include "test.h"
+
+using clock_type = std::chrono::steady_clock;
+
+//! milliseconds since @p start
+static long ms_since(clock_type::time_point start)
+{
+	return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+		clock_type::now() - start).count();
+}
+
+//! write counters 0 .. @p n - 1 as messages, each prefixed with @p id,
+//! in bursts with short pauses in between
+template<class Write>
+static void bursty_writer(int32_t id, int32_t n, Write write)
+{
+	std::mt19937 rng(id);
+	for(int32_t i = 0; i < n; )
+	{
+		for(int32_t end = std::min<int32_t>(n, i + 1 + rng() % 64);
+			i < end; )
+		{
+			const int32_t msg[2] = { id, i };
+			if(write((const char*)msg, sizeof(msg)))
+				++i;
+			else
+				std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(
+			rng() % 2000));
+	}
+}
+
+//! read all messages of @p writers writers of @p per_writer messages
+//! each, only sleeping in wait() while the ringbuffer is empty
+static void waiting_reader(spa::ringbuffer_in<char>& in, int writers,
+	int32_t per_writer)
+{
+	std::vector<int32_t> next(writers);
+	long read = 0, wrong = 0, slow_waits = 0;
+	const long total = (long)writers * per_writer;
+	const clock_type::time_point deadline = clock_type::now() +
+		std::chrono::seconds(60);
+	while(read < total && clock_type::now() < deadline)
+	{
+		const clock_type::time_point start = clock_type::now();
+		// the writers never pause for long, so a wait that runs into
+		// the timeout has missed its wakeup. Returning early without
+		// data is allowed, as futexes can wake up spuriously.
+		in.wait(5000);
+		if(ms_since(start) >= 1000)
+			++slow_waits;
+		int32_t msg[2];
+		while(in.read_msg((char*)msg, sizeof(msg)))
+		{
+			if(msg[0] < 0 || msg[0] >= writers || msg[1] != next[msg[0]]++)
+				++wrong;
+			++read;
+		}
+	}
+	CHECK(read == total);
+	CHECK(!wrong);
+	CHECK(!slow_waits);
+}
+
+int main()
+{
+	// without wakeups, wait() sleeps until the timeout
+	{
+		spa::ringbuffer<char> rb(256);
+		spa::ringbuffer_in<char> in(256);
+		in.connect(rb);
+		CHECK(!in.wait(10));
+		std::thread writer([&rb]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			rb.write_with_length("x", 1);
+		});
+		CHECK(in.wait(200));
+		writer.join();
+		// data is there: no sleep
+		const clock_type::time_point start = clock_type::now();
+		CHECK(in.wait(5000));
+		CHECK(ms_since(start) < 1000);
+	}
+
+	// single writer
+	{
+		spa::ringbuffer<char> rb(256);
+		rb.set_wakeup(true);
+		spa::ringbuffer_in<char> in(256);
+		in.connect(rb);
+		CHECK(!in.wait(10));
+		std::thread writer([&rb]() {
+			bursty_writer(0, 20000, [&rb](const char* msg, std::size_t len) {
+				return rb.try_write_with_length(msg, len); });
+		});
+		waiting_reader(in, 1, 20000);
+		writer.join();
+	}
+
+	// multiple writers, of which one wakes the reader
+	{
+		const int writers = 3;
+		spa::mpsc_ringbuffer rb(256);
+		rb.set_wakeup(true);
+		spa::ringbuffer_in<char> in(256);
+		in.connect(rb);
+		std::vector<std::thread> threads;
+		for(int32_t w = 0; w < writers; ++w)
+			threads.emplace_back([&rb, w]() {
+				bursty_writer(w, 5000, [&rb](const char* msg,
+					std::size_t len) {
+					std::size_t pos;
+					const spa::ring_region r = rb.reserve_shared(len + 4, pos);
+					if(!r.size())
+						return false;
+					spa::ringbuffer<char>::put_header(r, len, 0);
+					r.sub(4).copy_from(msg, len);
+					rb.commit_shared(pos, len + 4);
+					return true;
+				});
+			});
+		waiting_reader(in, writers, 5000);
+		for(std::thread& t : threads)
+			t.join();
+	}
+
+	return test::result();
+}
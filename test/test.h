@@ -0,0 +1,64 @@
+/*************************************************************************/
+/* test.h - minimal helpers for the unit tests                           */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file test.h
+	minimal helpers for the unit tests, each test is one executable that
+	returns EXIT_FAILURE if any check failed
+*/
+
+#ifndef SPA_TEST_H
+#define SPA_TEST_H
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace test {
+
+//! number of failed checks so far
+inline int& failures()
+{
+	static int n = 0;
+	return n;
+}
+
+//! count and print the failed check @p expr unless @p ok
+inline void check(bool ok, const char* expr, const char* file, int line)
+{
+	if(!ok)
+	{
+		std::fprintf(stderr, "%s:%d: check failed: %s\n",
+			file, line, expr);
+		++failures();
+	}
+}
+
+//! @return the exit code of a test
+inline int result()
+{
+	if(failures())
+		std::fprintf(stderr, "%d check(s) failed\n", failures());
+	return failures() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+} // namespace test
+
+#define CHECK(expr) test::check((expr), #expr, __FILE__, __LINE__)
+
+#endif // SPA_TEST_H